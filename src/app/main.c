@@ -2,11 +2,11 @@
 
 #include "../engine/platform.h"
 #include "../platform/platform_cute.h"
+#include "../platform/platform_jobs.h"
 #ifndef ENGINE_HOT_RELOADING
-#include "game/game.h"
+#include "../game/game.h"
 #endif
 
-#include <SDL3/SDL_timer.h>
 #include <cute_app.h>
 #include <cute_color.h>
 #include <cute_math.h>
@@ -14,27 +14,47 @@
 #include <cute_time.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "../engine/log.h"
+#include "../engine/memory.h"
 
+#ifdef ENGINE_HOT_RELOADING
 // Counter for number of times the game has been reloaded
 static int reloaded_counter = 0;
+#endif
 
-static void on_update(void* udata) {
+static void on_update([[maybe_unused]] void* udata) {
 #ifdef ENGINE_HOT_RELOADING
   GameLibrary* game_library = (GameLibrary*)udata;
 
   if (platform_game_library_has_changed(game_library)) {
     log_info("main", "Game library updated, reloading!");
 
-    void* game_state = game_library->state();
-    platform_unload_game_library(game_library);
+    // Loaded next to the running library, which is kept unless the new one
+    // can take over its state
+    GameLibrary new_game_library = platform_load_game_library(game_library);
+    bool compatible =
+        new_game_library.ok &&
+        new_game_library.state_layout() == game_library->state_layout();
+
+    if (!compatible) {
+      if (new_game_library.ok) {
+        log_warn("main", "GameState layout changed, restart to load the new "
+                         "library; keeping the running one");
+      }
+      if (new_game_library.library) {
+        platform_unload_game_library(&new_game_library);
+      }
+    } else {
+      // Reloads happen between ticks, so the last tick's jobs may still be
+      // queued; the library joins the ones whose results it keeps
+      game_library->prepare_reload();
+
+      void* game_state = game_library->state();
+      platform_unload_game_library(game_library);
 
-    SDL_Delay(50);
-    GameLibrary new_game_library = platform_load_game_library();
-    if (new_game_library.ok) {
       ++reloaded_counter;
-
       log_info("main", "Game reloaded successfully! (total reloads: %d)",
                reloaded_counter);
 
@@ -53,15 +73,36 @@ static void on_update(void* udata) {
 #endif
 }
 
+// --record <path> / --replay <path>; anything else is left to the platform
+static const char* find_option(int argc, char* argv[], const char* name) {
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], name) == 0) {
+      return argv[i + 1];
+    }
+  }
+  return nullptr;
+}
+
 int main(int argc, char* argv[]) {
   platform_init(argc, argv);
 
   Platform platform = {
       .get_system_page_size = platform_get_page_size,
+      .job_worker_count     = platform_jobs_worker_count,
+      .job_submit           = platform_jobs_submit,
+      .job_parallel_for     = platform_jobs_parallel_for,
+      .job_wait             = platform_jobs_wait,
+      .log_submit           = log_submit,
+      .memory_tag           = memory_exchange_tag,
+      .memory_stats         = memory_get_stats,
+      .map_file             = platform_map_file,
+      .unmap_file           = platform_unmap_file,
+      .record_input_path    = find_option(argc, argv, "--record"),
+      .replay_input_path    = find_option(argc, argv, "--replay"),
   };
 
 #ifdef ENGINE_HOT_RELOADING
-  GameLibrary game_library = platform_load_game_library();
+  GameLibrary game_library = platform_load_game_library(nullptr);
   game_library.init(&platform);
 
   cf_set_update_udata(&game_library);
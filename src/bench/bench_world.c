@@ -0,0 +1,428 @@
+// bench_world.c - Headless ECS benchmark
+//
+// Builds a world per entity count, fills it with the game's archetypes and
+// times update_world over fixed ticks. No window or renderer is created.
+// Results are printed one JSON object per line:
+//
+//   {"bench":"update_world","entities":10000,"ticks":300,...}
+//
+// Allocations are counted by the tracking allocator (engine/memory.h):
+// allocs_per_frame over the timed ticks, and live and peak KB per tag.
+//
+// With --replay, the timed ticks are driven by a recording made with the
+// game's --record option and run for its length:
+//
+//   {"bench":"replay","entities":10000,"ticks":1800,...}
+//
+// A last run fires projectiles into a field of targets to time collision
+// detection:
+//
+//   {"bench":"collisions","projectiles":5000,"targets":500,...}
+//
+// The snapshot run times quicksave/quickload and the per-tick rewind history
+// on the mixed world:
+//
+//   {"bench":"snapshot","entities":10000,"bytes":...,"capture_us":...,...}
+//
+// With --alloc-budget, the run fails (exit status 2) when an update_world run
+// allocates more than that many times per tick on average; 0 enforces the
+// steady state of no allocations at all.
+//
+// Usage: bench_world [ticks] [--replay <path>] [--alloc-budget <allocs>]
+
+#include <SDL3/SDL_timer.h>
+#include <cute_alloc.h>
+#include <cute_app.h>
+#include <cute_defines.h>
+#include <cute_math.h>
+#include <cute_result.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config/config.h"
+#include "../engine/arena.h"
+#include "../engine/game_state.h"
+#include "../engine/memory.h"
+#include "../engine/platform.h"
+#include "../platform/platform_jobs.h"
+#include "world.h"
+
+#define BENCH_WARMUP_TICKS 30
+#define BENCH_DEFAULT_TICKS 300
+#define BENCH_DT (1.0f / SIM_TICK_RATE)
+
+#define BENCH_PROJECTILES 5000
+#define BENCH_TARGETS 500
+
+#define BENCH_SNAPSHOT_ENTITIES 10000
+
+static const size_t bench_entity_counts[] = {1000, 10000, 100000};
+
+// =============================================================================
+// World Setup
+// =============================================================================
+
+static uint32_t bench_rng = 0x9E3779B9u;
+
+static float bench_random(float min, float max) {
+  bench_rng = bench_rng * 1664525u + 1013904223u;
+  return min + (max - min) * (float)(bench_rng >> 8) / (float)(1u << 24);
+}
+
+// Mix of archetypes, spawned in batches:
+//   2/4 movers  - A_Mover
+//   1/4 agents  - A_Player (input/controller/state + movement)
+//   1/4 bodies  - A_Body (SoA integration and write-back)
+static void spawn_entities(size_t count) {
+  Arena* arena   = &state->scratch_arena;
+  ArenaTemp temp = arena_temp_begin(arena);
+
+  size_t agents = count / 4;
+  size_t bodies = count / 4;
+  size_t movers = count - agents - bodies;
+
+  ecs_entity_t* entities = ARENA_PUSH_ARRAY(arena, ecs_entity_t, count);
+  ECS_SPAWN_N(A_Mover, movers, entities);
+  ECS_SPAWN_N(A_Player, agents, entities + movers);
+  ECS_SPAWN_N(A_Body, bodies, entities + movers + agents);
+
+  for (size_t i = 0; i < count; i++) {
+    ecs_entity_t entity = entities[i];
+
+    CF_V2 position =
+        cf_v2(bench_random(-2000.0f, 2000.0f), bench_random(-2000.0f, 2000.0f));
+    CF_V2 velocity =
+        cf_v2(bench_random(-100.0f, 100.0f), bench_random(-100.0f, 100.0f));
+
+    auto transform      = ECS_GET(entity, C_Transform);
+    transform->position = position;
+
+    if (i >= movers + agents) {
+      make_body(entity, position, velocity);
+      continue;
+    }
+
+    auto v = ECS_GET(entity, C_Velocity);
+    *v     = velocity;
+
+    if (i >= movers) {
+      auto controller              = ECS_GET(entity, C_PlayerController);
+      controller->walk_speed       = 150.0f;
+      controller->facing_direction = cf_v2(1.0f, 0.0f);
+
+      auto ps      = ECS_GET(entity, C_PlayerState);
+      ps->current  = PLAYER_STATE_IDLE;
+      ps->behavior = (Behavior){.wait = BEHAVIOR_WAIT_NONE};
+    }
+  }
+
+  arena_temp_end(temp);
+}
+
+// Projectiles (circles, SoA bodies) crossing a field of slow box targets.
+// Only projectiles look for anything, so the grid holds just the targets.
+static void spawn_collision_scene(size_t projectiles, size_t targets) {
+  Arena* arena   = &state->scratch_arena;
+  ArenaTemp temp = arena_temp_begin(arena);
+
+  ecs_entity_t* entities =
+      ARENA_PUSH_ARRAY(arena, ecs_entity_t, projectiles + targets);
+  ECS_SPAWN_N(A_Target, targets, entities);
+  ECS_SPAWN_N(A_Projectile, projectiles, entities + targets);
+
+  for (size_t i = 0; i < projectiles + targets; i++) {
+    ecs_entity_t entity = entities[i];
+
+    CF_V2 position =
+        cf_v2(bench_random(-1000.0f, 1000.0f), bench_random(-1000.0f, 1000.0f));
+    auto transform      = ECS_GET(entity, C_Transform);
+    transform->position = position;
+
+    auto collider = ECS_GET(entity, C_Collider);
+
+    if (i < targets) {
+      auto v = ECS_GET(entity, C_Velocity);
+      *v = cf_v2(bench_random(-20.0f, 20.0f), bench_random(-20.0f, 20.0f));
+
+      collider->shape        = COLLIDER_AABB;
+      collider->half_extents = cf_v2(12.0f, 12.0f);
+      collider->layer        = COLLISION_LAYER_TARGET;
+      continue;
+    }
+
+    make_body(entity, position,
+              cf_v2(bench_random(-200.0f, 200.0f),
+                    bench_random(-200.0f, 200.0f)));
+
+    collider->shape  = COLLIDER_CIRCLE;
+    collider->radius = 2.0f;
+    collider->layer  = COLLISION_LAYER_PROJECTILE;
+    collider->mask   = COLLISION_LAYER_TARGET;
+  }
+
+  arena_temp_end(temp);
+}
+
+// =============================================================================
+// Benchmark
+// =============================================================================
+
+// Allocations of the ticks since the last reset, summed over every tag
+static int bench_allocs;
+
+// One tick is one frame for the tracker
+static void bench_tick(void) {
+  arena_reset(&state->scratch_arena);
+  update_world(BENCH_DT);
+  frame_arena_swap(&state->frame_arena);
+
+  memory_end_frame();
+  MemoryStats stats;
+  memory_get_stats(&stats);
+  bench_allocs += stats.total.frame_allocs;
+}
+
+// ,"memory":{"ecs":{"live_kb":...,"peak_kb":...},...}
+static void bench_print_memory(void) {
+  MemoryStats stats;
+  memory_get_stats(&stats);
+
+  printf(",\"memory\":{");
+  for (int i = 0; i < MEMORY_TAG_COUNT; i++) {
+    printf("%s\"%s\":{\"live_kb\":%zu,\"peak_kb\":%zu}", i > 0 ? "," : "",
+           memory_tag_name((MemoryTag)i), stats.tags[i].live_bytes / 1024,
+           stats.tags[i].peak_bytes / 1024);
+  }
+  printf("}");
+}
+
+static void bench_begin(Platform* platform) {
+  MEMORY_SCOPE(MEMORY_TAG_WORLD, state = cf_calloc(1, sizeof(GameState)));
+  state->platform = platform;
+  arena_init(&state->scratch_arena, "scratch", SCRATCH_ARENA_SIZE);
+  frame_arena_init(&state->frame_arena, "frame", FRAME_ARENA_SIZE);
+  asset_cache_init(&state->assets, platform);
+
+  init_world();
+}
+
+static void bench_end(void) {
+  shutdown_world();
+  asset_cache_free(&state->assets);
+  arena_free(&state->scratch_arena);
+  frame_arena_free(&state->frame_arena);
+  cf_free(state);
+  state = nullptr;
+}
+
+static double bench_seconds(uint64_t begin, uint64_t end) {
+  return (double)(end - begin) / (double)SDL_GetPerformanceFrequency();
+}
+
+// Returns the average allocations per timed tick
+static double bench_update_world(Platform* platform, size_t entity_count,
+                                 int ticks) {
+  bench_begin(platform);
+  spawn_entities(entity_count);
+
+  for (int i = 0; i < BENCH_WARMUP_TICKS; i++) {
+    bench_tick();
+  }
+
+  // Agents (A_Player) follow the recording during the timed ticks
+  const char* bench = "update_world";
+  if (platform->replay_input_path &&
+      input_replay_start_playback(&state->world.replay,
+                                  platform->replay_input_path)) {
+    bench = "replay";
+    ticks = (int)state->world.replay.tick_count;
+  }
+
+  bench_allocs   = 0;
+  uint64_t begin = SDL_GetPerformanceCounter();
+
+  for (int i = 0; i < ticks; i++) {
+    bench_tick();
+  }
+
+  uint64_t end = SDL_GetPerformanceCounter();
+
+  double ns_per_tick      = bench_seconds(begin, end) * 1e9 / ticks;
+  double allocs_per_frame = (double)bench_allocs / ticks;
+
+  printf("{\"bench\":\"%s\",\"entities\":%zu,\"ticks\":%d,"
+         "\"workers\":%d,\"ns_per_tick\":%.1f,\"ns_per_entity\":%.3f,"
+         "\"allocs_per_frame\":%.3f",
+         bench, entity_count, ticks, platform->job_worker_count(), ns_per_tick,
+         ns_per_tick / (double)entity_count, allocs_per_frame);
+  bench_print_memory();
+  printf("}\n");
+  fflush(stdout);
+
+  input_replay_stop(&state->world.replay);
+  bench_end();
+  return allocs_per_frame;
+}
+
+static void bench_collisions(Platform* platform, size_t projectiles,
+                             size_t targets, int ticks) {
+  bench_begin(platform);
+  spawn_collision_scene(projectiles, targets);
+
+  for (int i = 0; i < BENCH_WARMUP_TICKS; i++) {
+    bench_tick();
+  }
+
+  const Collisions* collisions = &state->world.collisions;
+  size_t pairs                 = 0;
+  size_t contacts              = 0;
+
+  uint64_t begin = SDL_GetPerformanceCounter();
+
+  for (int i = 0; i < ticks; i++) {
+    bench_tick();
+    pairs += collisions->pair_count;
+    contacts += collisions->contacts.count;
+  }
+
+  uint64_t end = SDL_GetPerformanceCounter();
+
+  printf("{\"bench\":\"collisions\",\"projectiles\":%zu,\"targets\":%zu,"
+         "\"ticks\":%d,\"ns_per_tick\":%.1f,\"pairs_per_tick\":%.1f,"
+         "\"contacts_per_tick\":%.1f}\n",
+         projectiles, targets, ticks, bench_seconds(begin, end) * 1e9 / ticks,
+         (double)pairs / ticks, (double)contacts / ticks);
+  fflush(stdout);
+
+  bench_end();
+}
+
+// Capture and restore of one snapshot, then ticks with a history push each
+// and a rewind back through them
+static void bench_snapshot(Platform* platform, size_t entity_count,
+                           int ticks) {
+  bench_begin(platform);
+  spawn_entities(entity_count);
+
+  for (int i = 0; i < BENCH_WARMUP_TICKS; i++) {
+    bench_tick();
+  }
+
+  World* world     = &state->world;
+  Snapshot* saved  = &world->quicksave;
+  uint64_t capture = 0;
+  uint64_t restore = 0;
+
+  for (int i = 0; i < ticks; i++) {
+    uint64_t begin = SDL_GetPerformanceCounter();
+    snapshot_capture(saved);
+    uint64_t middle = SDL_GetPerformanceCounter();
+    snapshot_restore(saved);
+    uint64_t end = SDL_GetPerformanceCounter();
+
+    capture += middle - begin;
+    restore += end - middle;
+  }
+
+  // Rewinding only ever goes back SNAPSHOT_HISTORY_TICKS
+  int history_ticks =
+      ticks < SNAPSHOT_HISTORY_TICKS ? ticks : SNAPSHOT_HISTORY_TICKS;
+
+  snapshot_history_push(&world->history);
+  uint64_t push = 0;
+  for (int i = 0; i < history_ticks; i++) {
+    bench_tick();
+    uint64_t begin = SDL_GetPerformanceCounter();
+    snapshot_history_push(&world->history);
+    push += SDL_GetPerformanceCounter() - begin;
+  }
+
+  size_t delta_bytes = world->history.delta_bytes;
+
+  uint64_t begin = SDL_GetPerformanceCounter();
+  while (snapshot_history_rewind(&world->history)) {
+  }
+  uint64_t rewind = SDL_GetPerformanceCounter() - begin;
+
+  printf("{\"bench\":\"snapshot\",\"entities\":%zu,\"bytes\":%zu,"
+         "\"capture_us\":%.1f,\"restore_us\":%.1f,\"push_us\":%.1f,"
+         "\"rewind_us\":%.1f,\"delta_bytes_per_tick\":%.1f}\n",
+         entity_count, saved->size,
+         bench_seconds(0, capture) * 1e6 / ticks,
+         bench_seconds(0, restore) * 1e6 / ticks,
+         bench_seconds(0, push) * 1e6 / history_ticks,
+         bench_seconds(0, rewind) * 1e6 / history_ticks,
+         (double)delta_bytes / history_ticks);
+  fflush(stdout);
+
+  bench_end();
+}
+
+int main(int argc, char* argv[]) {
+  int ticks           = BENCH_DEFAULT_TICKS;
+  const char* replay  = nullptr;
+  double alloc_budget = -1.0; // Not enforced
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      replay = argv[++i];
+    } else if (strcmp(argv[i], "--alloc-budget") == 0 && i + 1 < argc) {
+      alloc_budget = atof(argv[++i]);
+    } else {
+      ticks = atoi(argv[i]);
+    }
+  }
+
+  if (ticks <= 0) {
+    fprintf(stderr,
+            "usage: %s [ticks] [--replay <path>] [--alloc-budget <allocs>]\n",
+            argv[0]);
+    return 1;
+  }
+
+  // Counts the ECS, bodies, spatial grid, arenas and CF itself from here on
+  memory_init();
+
+  // Hidden, no renderer: only the CF runtime (input, fs, allocator) is needed
+  int options = CF_APP_OPTIONS_HIDDEN_BIT | CF_APP_OPTIONS_NO_GFX_BIT;
+
+  CF_Result result =
+      cf_make_app("bench_world", 0, 0, 0, 1, 1, options, argv[0]);
+  if (cf_is_error(result)) {
+    fprintf(stderr, "Failed to create app: %s\n", result.details);
+    return 1;
+  }
+
+  // Same job system the game gets from the host executable
+  platform_jobs_init();
+  Platform platform = {
+      .job_worker_count  = platform_jobs_worker_count,
+      .job_submit        = platform_jobs_submit,
+      .job_parallel_for  = platform_jobs_parallel_for,
+      .job_wait          = platform_jobs_wait,
+      .memory_tag        = memory_exchange_tag,
+      .memory_stats      = memory_get_stats,
+      .replay_input_path = replay,
+  };
+
+  int status = 0;
+  for (size_t i = 0; i < CF_ARRAY_SIZE(bench_entity_counts); i++) {
+    double allocs =
+        bench_update_world(&platform, bench_entity_counts[i], ticks);
+    if (alloc_budget >= 0.0 && allocs > alloc_budget) {
+      fprintf(stderr, "%zu entities: %.3f allocs per frame, budget %.3f\n",
+              bench_entity_counts[i], allocs, alloc_budget);
+      status = 2;
+    }
+  }
+  bench_collisions(&platform, BENCH_PROJECTILES, BENCH_TARGETS, ticks);
+  bench_snapshot(&platform, BENCH_SNAPSHOT_ENTITIES, ticks);
+
+  platform_jobs_shutdown();
+  cf_destroy_app();
+
+  return status;
+}
@@ -9,4 +9,15 @@
 #define CANVAS_HEIGHT 405
 #define CANVAS_SCALE 2
 
+// Simulation ticks per second. Rendering is not tied to it: frames run at the
+// display rate (vsync) and interpolate between the last two ticks, so the rate
+// can be lowered on weak hardware without visible stutter.
+#ifndef SIM_TICK_RATE
+#define SIM_TICK_RATE 60
+#endif
+
+#define SCRATCH_ARENA_SIZE (4 * 1024 * 1024)
+#define FRAME_ARENA_SIZE (4 * 1024 * 1024)
+#define TICK_ARENA_SIZE (4 * 1024 * 1024)
+
 #endif
@@ -0,0 +1,127 @@
+#include "arena.h"
+
+#include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "memory.h"
+
+// =============================================================================
+// Arena
+// =============================================================================
+
+void arena_init(Arena* arena, const char* name, size_t capacity) {
+  *arena = (Arena){.name = name, .capacity = capacity};
+  MEMORY_SCOPE(MEMORY_TAG_ARENA, arena->base = cf_alloc(capacity));
+  CF_ASSERT(arena->base != nullptr);
+}
+
+void arena_free(Arena* arena) {
+  cf_free(arena->base);
+  *arena = (Arena){0};
+}
+
+void arena_reset(Arena* arena) { arena->used = 0; }
+
+static size_t arena_align(size_t offset, size_t align) {
+  return (offset + align - 1) & ~(align - 1);
+}
+
+[[noreturn]] static void arena_overflow(const Arena* arena, size_t size) {
+  log_fatal("arena",
+            "%s arena out of space: %zu bytes requested, %zu of %zu used",
+            arena->name, size, arena->used, arena->capacity);
+  abort();
+}
+
+void* arena_push(Arena* arena, size_t size, size_t align) {
+  CF_ASSERT(align > 0 && (align & (align - 1)) == 0);
+
+  size_t offset = arena_align(arena->used, align);
+  if (offset > arena->capacity || size > arena->capacity - offset) {
+    arena_overflow(arena, size);
+  }
+
+  arena->used = offset + size;
+  if (arena->used > arena->high_water) {
+    arena->high_water = arena->used;
+  }
+
+  void* ptr = arena->base + offset;
+  memset(ptr, 0, size);
+  return ptr;
+}
+
+// -----------------------------------------------------------------------------
+// Temp Scopes
+// -----------------------------------------------------------------------------
+
+ArenaTemp arena_temp_begin(Arena* arena) {
+  return (ArenaTemp){.arena = arena, .used = arena->used};
+}
+
+void arena_temp_end(ArenaTemp temp) {
+  CF_ASSERT(temp.used <= temp.arena->used);
+  temp.arena->used = temp.used;
+}
+
+// -----------------------------------------------------------------------------
+// Growable Arrays
+// -----------------------------------------------------------------------------
+
+void arena_array_grow(Arena* arena, void** items, size_t* capacity,
+                      size_t count, size_t item_size, size_t align) {
+  size_t new_capacity = *capacity ? *capacity * 2 : 16;
+  uint8_t* old        = *items;
+
+  // Last allocation: extend it where it is
+  if (old && old + *capacity * item_size == arena->base + arena->used) {
+    size_t extra = (new_capacity - *capacity) * item_size;
+    if (extra > arena->capacity - arena->used) {
+      arena_overflow(arena, extra);
+    }
+
+    memset(arena->base + arena->used, 0, extra);
+    arena->used += extra;
+    if (arena->used > arena->high_water) {
+      arena->high_water = arena->used;
+    }
+
+    *capacity = new_capacity;
+    return;
+  }
+
+  void* grown = arena_push(arena, new_capacity * item_size, align);
+  if (count > 0) {
+    memcpy(grown, old, count * item_size);
+  }
+
+  *items    = grown;
+  *capacity = new_capacity;
+}
+
+// =============================================================================
+// Frame Arena
+// =============================================================================
+
+void frame_arena_init(FrameArena* frame, const char* name, size_t capacity) {
+  arena_init(&frame->buffers[0], name, capacity);
+  arena_init(&frame->buffers[1], name, capacity);
+  frame->current = 0;
+}
+
+void frame_arena_free(FrameArena* frame) {
+  arena_free(&frame->buffers[0]);
+  arena_free(&frame->buffers[1]);
+}
+
+Arena* frame_arena_current(FrameArena* frame) {
+  return &frame->buffers[frame->current];
+}
+
+void frame_arena_swap(FrameArena* frame) {
+  frame->current ^= 1;
+  arena_reset(&frame->buffers[frame->current]);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// Arena
+// =============================================================================
+// Fixed-capacity bump allocator for per-frame data. Running out of space is a
+// fatal error rather than a fallback to the heap, so sizes stay visible: the
+// high-water mark is shown in the debug overlay.
+
+typedef struct Arena {
+  const char* name; // For error messages and the overlay
+  uint8_t* base;
+  size_t capacity;
+  size_t used;
+  size_t high_water; // Largest `used` since init
+} Arena;
+
+void arena_init(Arena* arena, const char* name, size_t capacity);
+void arena_free(Arena* arena);
+void arena_reset(Arena* arena);
+
+// Returns `size` zeroed bytes aligned to `align` (a power of two).
+void* arena_push(Arena* arena, size_t size, size_t align);
+
+#define ARENA_PUSH(ARENA, T) ((T*)arena_push(ARENA, sizeof(T), alignof(T)))
+
+#define ARENA_PUSH_ARRAY(ARENA, T, COUNT)                                      \
+  ((T*)arena_push(ARENA, sizeof(T) * (COUNT), alignof(T)))
+
+// -----------------------------------------------------------------------------
+// Temp Scopes
+// -----------------------------------------------------------------------------
+// Everything pushed between begin and end is released by end. Scopes nest.
+
+typedef struct ArenaTemp {
+  Arena* arena;
+  size_t used;
+} ArenaTemp;
+
+ArenaTemp arena_temp_begin(Arena* arena);
+void arena_temp_end(ArenaTemp temp);
+
+// -----------------------------------------------------------------------------
+// Growable Arrays
+// -----------------------------------------------------------------------------
+// Any struct with `items`, `count` and `capacity` members, zero-initialized:
+//
+//   struct { ecs_entity_t* items; size_t count; size_t capacity; } hits = {0};
+//   ARENA_ARRAY_PUSH(arena, &hits, entity);
+//
+// Growth doubles the capacity; while the array is the arena's last allocation
+// it grows in place, otherwise it moves and the old block is left until reset.
+
+#define ARENA_ARRAY_PUSH(ARENA, ARRAY, VALUE)                                  \
+  do {                                                                         \
+    if ((ARRAY)->count == (ARRAY)->capacity) {                                 \
+      arena_array_grow(ARENA, (void**)&(ARRAY)->items, &(ARRAY)->capacity,     \
+                       (ARRAY)->count, sizeof(*(ARRAY)->items),                \
+                       alignof(typeof(*(ARRAY)->items)));                      \
+    }                                                                          \
+    (ARRAY)->items[(ARRAY)->count++] = (VALUE);                                \
+  } while (0)
+
+void arena_array_grow(Arena* arena, void** items, size_t* capacity,
+                      size_t count, size_t item_size, size_t align);
+
+// =============================================================================
+// Frame Arena
+// =============================================================================
+// Two arenas that alternate each frame. Data pushed during frame N remains
+// valid through frame N + 1, so results can be read by render (and by the
+// next frame) without copying. A frame can run any number of fixed ticks, so
+// per-tick outputs use an arena reset every tick instead (World.tick_arena).
+
+typedef struct FrameArena {
+  Arena buffers[2];
+  int current;
+} FrameArena;
+
+void frame_arena_init(FrameArena* frame, const char* name, size_t capacity);
+void frame_arena_free(FrameArena* frame);
+
+// Arena for this frame's allocations
+Arena* frame_arena_current(FrameArena* frame);
+
+// Ends the frame: the older buffer is reset and becomes current.
+void frame_arena_swap(FrameArena* frame);
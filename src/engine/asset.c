@@ -1,10 +1,22 @@
 #include "asset.h"
 
+#include <SDL3/SDL_timer.h>
+#include <cute_alloc.h>
 #include <cute_array.h>
 #include <cute_c_runtime.h>
 #include <cute_file_system.h>
+#include <cute_image.h>
+#include <cute_map.h>
+#include <cute_multithreading.h>
 #include <cute_result.h>
 #include <cute_sprite.h>
+#include <cute_string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "log.h"
+#include "memory.h"
+#include "platform.h"
 
 CF_Result asset_load_sprite(const char* filepath, CF_Sprite* out_sprite) {
   CF_ASSERT(out_sprite != nullptr);
@@ -31,3 +43,344 @@ CF_Result asset_load_sprite(const char* filepath, CF_Sprite* out_sprite) {
 
   return cf_result_error("Unsupported sprite file format");
 }
+
+// =============================================================================
+// Sprite Cache
+// =============================================================================
+
+#define ASSET_PLACEHOLDER_SIZE 16
+
+struct AssetLoad {
+  const char* path;
+  bool png;
+  void* data; // Aseprite file contents
+  size_t size;
+  CF_Image image; // Decoded PNG
+  CF_Result result;
+  JobCounter counter;
+};
+
+static uint64_t asset_key(const char* interned) {
+  return (uint64_t)(uintptr_t)interned;
+}
+
+static AssetSprite* asset_slot(const AssetCache* cache, AssetHandle handle) {
+  if (handle.id == 0 || handle.id > (uint32_t)cf_array_count(cache->sprites)) {
+    return nullptr;
+  }
+
+  AssetSprite* slot = &cache->sprites[handle.id - 1];
+  return slot->path ? slot : nullptr;
+}
+
+// Magenta/black checker, the usual "not loaded yet" texture
+static const CF_Sprite* asset_placeholder(AssetCache* cache) {
+  if (!cache->has_placeholder) {
+    CF_Pixel magenta = cf_pixel_rgba(255, 0, 255, 255);
+    CF_Pixel black   = cf_pixel_rgba(0, 0, 0, 255);
+    CF_Pixel pixels[ASSET_PLACEHOLDER_SIZE * ASSET_PLACEHOLDER_SIZE];
+
+    for (int y = 0; y < ASSET_PLACEHOLDER_SIZE; y++) {
+      for (int x = 0; x < ASSET_PLACEHOLDER_SIZE; x++) {
+        bool odd = ((x / 4) + (y / 4)) & 1;
+        pixels[y * ASSET_PLACEHOLDER_SIZE + x] = odd ? magenta : black;
+      }
+    }
+
+    cache->placeholder = cf_make_easy_sprite_from_pixels(
+        pixels, ASSET_PLACEHOLDER_SIZE, ASSET_PLACEHOLDER_SIZE);
+    cache->has_placeholder = true;
+  }
+
+  return &cache->placeholder;
+}
+
+// -----------------------------------------------------------------------------
+// Loading
+// -----------------------------------------------------------------------------
+
+// Worker: file I/O and PNG decoding only, nothing that touches the GPU
+static void asset_read(AssetLoad* load) {
+  if (!load->png && !spext_equ(load->path, ".aseprite") &&
+      !spext_equ(load->path, ".ase")) {
+    load->result = cf_result_error("Unsupported sprite file format");
+    return;
+  }
+
+  load->data = cf_fs_read_entire_file_to_memory(load->path, &load->size);
+  if (!load->data) {
+    load->result = cf_result_error("Failed to read file");
+    return;
+  }
+
+  if (load->png) {
+    load->result = cf_image_load_png_from_memory(load->data, (int)load->size,
+                                                 &load->image);
+    cf_free(load->data);
+    load->data = nullptr;
+    return;
+  }
+
+  load->result = cf_result_success();
+}
+
+static void asset_read_job(void* udata) {
+  MEMORY_SCOPE(MEMORY_TAG_ASSETS, asset_read(udata));
+}
+
+static bool asset_load_done(AssetLoad* load) {
+  return cf_atomic_get(&load->counter.pending) == 0;
+}
+
+static void asset_load_free(AssetLoad* load) {
+  cf_free(load->data);
+  if (load->image.pix) {
+    cf_image_free(&load->image);
+  }
+  cf_free(load);
+}
+
+// Main thread: creates the sprite (atlas upload) from a finished read
+static void asset_finish_load(AssetSprite* slot) {
+  AssetLoad* load  = slot->load;
+  CF_Result result = load->result;
+
+  if (!cf_is_error(result)) {
+    if (load->png) {
+      slot->sprite = cf_make_easy_sprite_from_pixels(
+          load->image.pix, load->image.w, load->image.h);
+    } else {
+      slot->sprite =
+          cf_make_sprite_from_memory(slot->path, load->data, (int)load->size);
+      if (!slot->sprite.name) {
+        result = cf_result_error("Failed to load Aseprite sprite");
+      }
+    }
+  }
+
+  if (cf_is_error(result)) {
+    log_error("asset", "Failed to load sprite %s: %s", slot->path,
+              result.details);
+    slot->state = ASSET_STATE_FAILED;
+  } else {
+    log_debug("asset", "Loaded sprite %s", slot->path);
+    slot->state = ASSET_STATE_READY;
+  }
+
+  asset_load_free(load);
+  slot->load = nullptr;
+}
+
+static void asset_stop_loading(AssetCache* cache, uint32_t index) {
+  for (int i = 0; i < cf_array_count(cache->loading); i++) {
+    if (cache->loading[i] == index) {
+      cache->loading[i] = cf_array_last(cache->loading);
+      cf_array_pop(cache->loading);
+      return;
+    }
+  }
+}
+
+// Blocks until the slot's read is finished (helping with queued jobs)
+static void asset_wait(AssetCache* cache, AssetSprite* slot) {
+  if (slot->load && cache->platform) {
+    cache->platform->job_wait(&slot->load->counter);
+  }
+}
+
+static void asset_start_load(AssetCache* cache, uint32_t index) {
+  AssetSprite* slot = &cache->sprites[index];
+
+  // Cooked: the table already has everything, nothing to read or decode
+  if (atlas_make_sprite(&cache->atlas, slot->path, &slot->sprite)) {
+    slot->state  = ASSET_STATE_READY;
+    slot->cooked = true;
+    return;
+  }
+
+  AssetLoad* load = cf_calloc(1, sizeof(AssetLoad));
+  load->path      = slot->path;
+  load->png       = spext_equ(slot->path, ".png");
+  slot->load      = load;
+  slot->state     = ASSET_STATE_LOADING;
+
+  // No job system (e.g. headless tools), or timing must not matter: load in
+  // place
+  if (cache->synchronous || !cache->platform || !cache->platform->job_submit) {
+    asset_read_job(load);
+    asset_finish_load(slot);
+    return;
+  }
+
+  cache->platform->job_submit(asset_read_job, load, &load->counter);
+  cf_array_push(cache->loading, index);
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+static void asset_unload_sprite(AssetCache* cache, AssetSprite* slot) {
+  if (slot->load) {
+    asset_wait(cache, slot);
+    asset_load_free(slot->load);
+    slot->load = nullptr;
+  }
+
+  if (slot->state != ASSET_STATE_READY || slot->cooked) {
+    return;
+  }
+
+  if (slot->sprite.easy_sprite_id) {
+    cf_easy_sprite_unload(&slot->sprite);
+  } else {
+    cf_sprite_unload(slot->path);
+  }
+}
+
+void asset_cache_init(AssetCache* cache, Platform* platform) {
+  *cache          = (AssetCache){0};
+  cache->platform = platform;
+
+  bool cooked;
+  MEMORY_SCOPE(MEMORY_TAG_ASSETS,
+               cooked = atlas_open(&cache->atlas, platform, ATLAS_TABLE_PATH));
+  if (!cooked) {
+    log_debug("asset", "No cooked atlas, loading sprites from source files");
+  }
+}
+
+void asset_cache_free(AssetCache* cache) {
+  for (int i = 0; i < cf_array_count(cache->sprites); i++) {
+    if (cache->sprites[i].path) {
+      asset_unload_sprite(cache, &cache->sprites[i]);
+    }
+  }
+
+  if (cache->has_placeholder) {
+    cf_easy_sprite_unload(&cache->placeholder);
+  }
+
+  atlas_close(&cache->atlas);
+
+  cf_array_free(cache->sprites);
+  cf_array_free(cache->free_slots);
+  cf_array_free(cache->loading);
+  cf_map_free(cache->lookup);
+  *cache = (AssetCache){0};
+}
+
+void asset_cache_wait(AssetCache* cache) {
+  for (int i = 0; i < cf_array_count(cache->loading); i++) {
+    asset_wait(cache, &cache->sprites[cache->loading[i]]);
+  }
+}
+
+void asset_cache_update(AssetCache* cache, double budget_ms) {
+  uint64_t start = SDL_GetTicksNS();
+
+  for (int i = 0; i < cf_array_count(cache->loading);) {
+    AssetSprite* slot = &cache->sprites[cache->loading[i]];
+    if (!asset_load_done(slot->load)) {
+      i++;
+      continue;
+    }
+
+    MEMORY_SCOPE(MEMORY_TAG_ASSETS, asset_finish_load(slot));
+    cache->loading[i] = cf_array_last(cache->loading);
+    cf_array_pop(cache->loading);
+
+    if ((double)(SDL_GetTicksNS() - start) / 1e6 >= budget_ms) {
+      break;
+    }
+  }
+}
+
+static AssetHandle asset_acquire(AssetCache* cache, const char* path) {
+  const char* interned = cf_sintern(path);
+  uint64_t key         = asset_key(interned);
+
+  if (cf_map_has(cache->lookup, key)) {
+    AssetHandle handle = {cf_map_get(cache->lookup, key)};
+    asset_slot(cache, handle)->refs++;
+    return handle;
+  }
+
+  uint32_t index;
+  if (cf_array_count(cache->free_slots) > 0) {
+    index = cf_array_pop(cache->free_slots);
+  } else {
+    index = (uint32_t)cf_array_count(cache->sprites);
+    cf_array_push(cache->sprites, (AssetSprite){0});
+  }
+
+  if (++cache->generation == 0) {
+    cache->generation = 1;
+  }
+  cache->sprites[index] = (AssetSprite){
+      .path = interned, .generation = cache->generation, .refs = 1};
+
+  AssetHandle handle = {index + 1};
+  cf_map_set(cache->lookup, key, handle.id);
+
+  asset_start_load(cache, index);
+  return handle;
+}
+
+AssetHandle asset_acquire_sprite(AssetCache* cache, const char* path) {
+  CF_ASSERT(cache != nullptr);
+
+  if (!path) {
+    return (AssetHandle){0};
+  }
+
+  AssetHandle handle;
+  MEMORY_SCOPE(MEMORY_TAG_ASSETS, handle = asset_acquire(cache, path));
+  return handle;
+}
+
+void asset_release_sprite(AssetCache* cache, AssetHandle handle) {
+  AssetSprite* slot = asset_slot(cache, handle);
+  if (!slot || --slot->refs > 0) {
+    return;
+  }
+
+  if (slot->load) {
+    asset_stop_loading(cache, handle.id - 1);
+  }
+
+  asset_unload_sprite(cache, slot);
+  cf_map_del(cache->lookup, asset_key(slot->path));
+  *slot = (AssetSprite){0};
+  cf_array_push(cache->free_slots, handle.id - 1);
+}
+
+const char* asset_path(const AssetCache* cache, AssetHandle handle) {
+  const AssetSprite* slot = asset_slot(cache, handle);
+  return slot ? slot->path : nullptr;
+}
+
+uint32_t asset_generation(const AssetCache* cache, AssetHandle handle) {
+  const AssetSprite* slot = asset_slot(cache, handle);
+  return slot ? slot->generation : 0;
+}
+
+bool asset_is_ready(const AssetCache* cache, AssetHandle handle) {
+  const AssetSprite* slot = asset_slot(cache, handle);
+  return slot && slot->state == ASSET_STATE_READY;
+}
+
+bool asset_is_settled(const AssetCache* cache, AssetHandle handle) {
+  const AssetSprite* slot = asset_slot(cache, handle);
+  return slot && slot->state != ASSET_STATE_LOADING;
+}
+
+CF_Sprite asset_sprite(AssetCache* cache, AssetHandle handle) {
+  const AssetSprite* slot = asset_slot(cache, handle);
+  if (!slot) {
+    return cf_sprite_defaults();
+  }
+
+  return slot->state == ASSET_STATE_READY ? slot->sprite
+                                          : *asset_placeholder(cache);
+}
@@ -1,9 +1,117 @@
 #ifndef ASSET_H
 #define ASSET_H
 
+#include <cute_map.h>
 #include <cute_result.h>
 #include <cute_sprite.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "atlas.h"
 
 CF_Result asset_load_sprite(const char* filepath, CF_Sprite* out_sprite);
 
+// =============================================================================
+// Sprite Cache
+// =============================================================================
+// Sprites are loaded once per path and shared. Entities keep only a CF_Sprite
+// instance (current animation, frame, timer, scale/flip) copied from the
+// cached template; frames and atlas pages stay with the cache entry.
+//
+// Sprites found in the cooked atlas (see atlas.h) are ready immediately.
+// Other loads are asynchronous: the file is read (and PNGs decoded) on a
+// platform job, then asset_cache_update creates the sprite on the main thread
+// within a frame budget. Until then asset_sprite hands out a placeholder.
+// With `synchronous` set, every load finishes inside asset_acquire_sprite, so
+// when a sprite becomes ready doesn't depend on I/O timing.
+
+// Main-thread time per frame spent turning finished reads into sprites
+#ifndef ASSET_FINISH_BUDGET_MS
+#define ASSET_FINISH_BUDGET_MS 2.0
+#endif
+
+typedef struct Platform Platform;
+
+// Handle to a cached sprite. Zero is invalid.
+typedef struct AssetHandle {
+  uint32_t id;
+} AssetHandle;
+
+typedef enum AssetState {
+  ASSET_STATE_LOADING,
+  ASSET_STATE_READY,
+  ASSET_STATE_FAILED,
+} AssetState;
+
+// File read in flight on a worker, owned by the cache entry
+typedef struct AssetLoad AssetLoad;
+
+typedef struct AssetSprite {
+  const char* path; // Interned; nullptr while the slot is free
+  CF_Sprite sprite; // Template instance, valid once ready
+  AssetState state;
+  AssetLoad* load;
+  uint32_t generation; // New for every acquire of a free slot, never zero
+  bool cooked; // Frames live in the atlas, which outlives the entry
+  int refs;
+} AssetSprite;
+
+// Lives in GameState so it survives game library reloads.
+typedef struct AssetCache {
+  Platform* platform;      // Worker jobs; nullptr loads synchronously
+  AssetSprite* sprites;    // Dynamic array; handle id - 1 is the slot
+  uint32_t* free_slots;    // Dynamic array of reusable slots
+  uint32_t* loading;       // Dynamic array of slots with a read in flight
+  CF_MAP(uint32_t) lookup; // Interned path -> handle id
+  Atlas atlas;             // Cooked sprites, if the table was found
+  CF_Sprite placeholder;   // Shown while loading, created on first use
+  bool has_placeholder;
+  uint32_t generation; // Last one handed to a slot
+  bool synchronous; // Load in place even with workers (input replay)
+} AssetCache;
+
+// Also maps the cooked atlas at ATLAS_TABLE_PATH when the platform can.
+void asset_cache_init(AssetCache* cache, Platform* platform);
+
+// Waits for pending reads, unloads every sprite, released or not, and frees
+// the cache storage.
+void asset_cache_free(AssetCache* cache);
+
+// Blocks until every read in flight has finished; asset_cache_update still
+// turns them into sprites. The read job is game library code, so call this
+// before the library is unloaded.
+void asset_cache_wait(AssetCache* cache);
+
+// Creates sprites for finished reads until `budget_ms` is spent (at least one
+// per call). Main thread, once per frame.
+void asset_cache_update(AssetCache* cache, double budget_ms);
+
+// Returns a handle to the sprite at `path`, queueing a load on first use.
+// Each call with a valid handle result must be paired with
+// asset_release_sprite. Returns an invalid handle for a nullptr path.
+AssetHandle asset_acquire_sprite(AssetCache* cache, const char* path);
+
+// Drops a reference; the sprite is unloaded when the last one goes.
+void asset_release_sprite(AssetCache* cache, AssetHandle handle);
+
+// Interned path the handle was acquired with; nullptr for a released or
+// invalid handle.
+const char* asset_path(const AssetCache* cache, AssetHandle handle);
+
+// Identifies the sprite a slot currently holds: a released slot acquired again
+// gets a new one, though the handle and path are the same. Zero for a
+// released or invalid handle. For caches of data derived from the sprite.
+uint32_t asset_generation(const AssetCache* cache, AssetHandle handle);
+
+// True once the real sprite can be handed out by asset_sprite.
+bool asset_is_ready(const AssetCache* cache, AssetHandle handle);
+
+// True once loading is over, whether it succeeded or failed. A failed sprite
+// stays on the placeholder for good.
+bool asset_is_settled(const AssetCache* cache, AssetHandle handle);
+
+// New playback instance of a cached sprite: the placeholder while loading or
+// after a failed load, cf_sprite_defaults() for an invalid handle.
+CF_Sprite asset_sprite(AssetCache* cache, AssetHandle handle);
+
 #endif // ASSET_H
@@ -0,0 +1,273 @@
+#include "atlas.h"
+
+#include <cute_alloc.h>
+#include <cute_array.h>
+#include <cute_map.h>
+#include <cute_sprite.h>
+#include <cute_string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "log.h"
+#include "platform.h"
+
+// =============================================================================
+// Table
+// =============================================================================
+
+// Checks the header and that every section fits in the mapping
+static bool atlas_bind(Atlas* atlas) {
+  if (atlas->size < sizeof(AtlasHeader)) {
+    return false;
+  }
+
+  const AtlasHeader* header = atlas->data;
+  if (header->magic != ATLAS_MAGIC || header->version != ATLAS_VERSION) {
+    return false;
+  }
+
+  size_t pages      = sizeof(AtlasHeader);
+  size_t sprites    = pages + header->page_count * sizeof(AtlasPage);
+  size_t animations = sprites + header->sprite_count * sizeof(AtlasSprite);
+  size_t frames =
+      animations + header->animation_count * sizeof(AtlasAnimation);
+  size_t strings = frames + header->frame_count * sizeof(AtlasFrame);
+
+  if (strings + header->strings_size > atlas->size) {
+    return false;
+  }
+
+  const char* base  = atlas->data;
+  atlas->header     = header;
+  atlas->pages      = (const AtlasPage*)(base + pages);
+  atlas->sprites    = (const AtlasSprite*)(base + sprites);
+  atlas->animations = (const AtlasAnimation*)(base + animations);
+  atlas->frames     = (const AtlasFrame*)(base + frames);
+  atlas->strings    = base + strings;
+  return true;
+}
+
+// A NUL-terminated string starting inside the string block
+static bool atlas_valid_string(const Atlas* atlas, uint32_t offset) {
+  uint32_t size = atlas->header->strings_size;
+  return offset < size &&
+         memchr(atlas->strings + offset, '\0', size - offset) != nullptr;
+}
+
+// A range of `count` records from `first` inside a section of `total`
+static bool atlas_valid_range(uint32_t first, uint32_t count, uint32_t total) {
+  return (uint64_t)first + count <= total;
+}
+
+// Checks every record once, so lookups and sprite builds can index freely
+static bool atlas_validate(const Atlas* atlas) {
+  const AtlasHeader* header = atlas->header;
+
+  for (uint32_t i = 0; i < header->page_count; i++) {
+    const AtlasPage* page = &atlas->pages[i];
+    if (!atlas_valid_string(atlas, page->path) || page->w == 0 ||
+        page->h == 0) {
+      return false;
+    }
+  }
+
+  for (uint32_t i = 0; i < header->frame_count; i++) {
+    if (atlas->frames[i].page >= header->page_count) {
+      return false;
+    }
+  }
+
+  for (uint32_t i = 0; i < header->sprite_count; i++) {
+    // The cooker gives every sprite at least a "default" clip, which
+    // atlas_make_sprite starts on
+    const AtlasSprite* sprite = &atlas->sprites[i];
+    if (!atlas_valid_string(atlas, sprite->path) ||
+        sprite->animation_count == 0 ||
+        !atlas_valid_range(sprite->first_frame, sprite->frame_count,
+                           header->frame_count) ||
+        !atlas_valid_range(sprite->first_animation, sprite->animation_count,
+                           header->animation_count)) {
+      return false;
+    }
+
+    // Only the sprite's own frames are registered with CF
+    for (uint32_t a = 0; a < sprite->animation_count; a++) {
+      const AtlasAnimation* anim =
+          &atlas->animations[sprite->first_animation + a];
+      if (!atlas_valid_string(atlas, anim->name) ||
+          anim->direction > CF_PLAY_DIRECTION_PINGPONG ||
+          anim->first_frame < sprite->first_frame ||
+          !atlas_valid_range(anim->first_frame - sprite->first_frame,
+                             anim->frame_count, sprite->frame_count)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static uint64_t atlas_frame_id(uint32_t frame) {
+  return ATLAS_IMAGE_ID_BASE + frame;
+}
+
+// Hands each page and the frames on it to CF as a premade atlas
+static void atlas_register_pages(Atlas* atlas) {
+  const AtlasHeader* header = atlas->header;
+
+  for (uint32_t page = 0; page < header->page_count; page++) {
+    const AtlasPage* p = &atlas->pages[page];
+    dyna CF_AtlasSubImage* images = nullptr;
+
+    for (uint32_t s = 0; s < header->sprite_count; s++) {
+      const AtlasSprite* sprite = &atlas->sprites[s];
+
+      for (uint32_t i = 0; i < sprite->frame_count; i++) {
+        uint32_t frame_index = sprite->first_frame + i;
+        const AtlasFrame* f  = &atlas->frames[frame_index];
+        if (f->page != page) {
+          continue;
+        }
+
+        CF_AtlasSubImage image = {
+            .image_id = atlas_frame_id(frame_index),
+            .w        = sprite->w,
+            .h        = sprite->h,
+            .minx     = (float)f->x / (float)p->w,
+            .miny     = (float)f->y / (float)p->h,
+            .maxx     = (float)(f->x + sprite->w) / (float)p->w,
+            .maxy     = (float)(f->y + sprite->h) / (float)p->h,
+        };
+        cf_array_push(images, image);
+      }
+    }
+
+    cf_register_premade_atlas(atlas->strings + p->path,
+                              cf_array_count(images), images);
+    cf_array_free(images);
+  }
+}
+
+// =============================================================================
+// Sprites
+// =============================================================================
+
+static void atlas_build_sprite(Atlas* atlas, uint32_t index) {
+  const AtlasSprite* sprite   = &atlas->sprites[index];
+  const AtlasAnimation* anims = &atlas->animations[sprite->first_animation];
+  AtlasSpriteData* data       = &atlas->built[index];
+
+  data->animations =
+      cf_calloc(sprite->animation_count, sizeof(CF_Animation));
+
+  for (uint32_t a = 0; a < sprite->animation_count; a++) {
+    CF_Animation* animation   = &data->animations[a];
+    animation->name           = cf_sintern(atlas->strings + anims[a].name);
+    animation->play_direction = (CF_PlayDirection)anims[a].direction;
+
+    for (uint32_t i = 0; i < anims[a].frame_count; i++) {
+      uint32_t frame_index = anims[a].first_frame + i;
+      float delay_ms       = atlas->frames[frame_index].delay_ms;
+
+      CF_Frame frame = {.id    = atlas_frame_id(frame_index),
+                        .delay = delay_ms / 1000.0f};
+      cf_array_push(animation->frames, frame);
+    }
+
+    cf_map_set(data->table, (uint64_t)(uintptr_t)animation->name,
+               (const CF_Animation*)animation);
+  }
+}
+
+bool atlas_make_sprite(Atlas* atlas, const char* path, CF_Sprite* out_sprite) {
+  uint64_t key = (uint64_t)(uintptr_t)path;
+  if (!atlas->data || !cf_map_has(atlas->lookup, key)) {
+    return false;
+  }
+
+  uint32_t index            = cf_map_get(atlas->lookup, key);
+  const AtlasSprite* sprite = &atlas->sprites[index];
+
+  if (!atlas->built[index].animations) {
+    atlas_build_sprite(atlas, index);
+  }
+
+  const AtlasSpriteData* data = &atlas->built[index];
+
+  *out_sprite            = cf_sprite_defaults();
+  out_sprite->name       = path;
+  out_sprite->w          = sprite->w;
+  out_sprite->h          = sprite->h;
+  out_sprite->animations = data->table;
+  out_sprite->animation  = &data->animations[0];
+  return true;
+}
+
+// =============================================================================
+// Lifetime
+// =============================================================================
+
+bool atlas_open(Atlas* atlas, Platform* platform, const char* path) {
+  *atlas = (Atlas){0};
+
+  if (!platform || !platform->map_file) {
+    return false;
+  }
+
+  atlas->platform = platform;
+  atlas->data     = platform->map_file(path, &atlas->size);
+  if (!atlas->data) {
+    return false;
+  }
+
+  if (!atlas_bind(atlas)) {
+    log_warn("atlas", "Ignoring %s: built by a different cooker version", path);
+    atlas_close(atlas);
+    return false;
+  }
+
+  if (!atlas_validate(atlas)) {
+    log_warn("atlas", "Ignoring %s: a record points outside the table", path);
+    atlas_close(atlas);
+    return false;
+  }
+
+  atlas->built =
+      cf_calloc(atlas->header->sprite_count, sizeof(AtlasSpriteData));
+  for (uint32_t i = 0; i < atlas->header->sprite_count; i++) {
+    const char* sprite = cf_sintern(atlas->strings + atlas->sprites[i].path);
+    cf_map_set(atlas->lookup, (uint64_t)(uintptr_t)sprite, i);
+  }
+
+  atlas_register_pages(atlas);
+
+  log_info("atlas", "Mapped %s: %u sprites on %u pages", path,
+           atlas->header->sprite_count, atlas->header->page_count);
+  return true;
+}
+
+void atlas_close(Atlas* atlas) {
+  if (atlas->built) {
+    for (uint32_t i = 0; i < atlas->header->sprite_count; i++) {
+      AtlasSpriteData* data = &atlas->built[i];
+      if (!data->animations) {
+        continue;
+      }
+
+      for (uint32_t a = 0; a < atlas->sprites[i].animation_count; a++) {
+        cf_array_free(data->animations[a].frames);
+      }
+      cf_free(data->animations);
+      cf_map_free(data->table);
+    }
+    cf_free(atlas->built);
+  }
+
+  if (atlas->data) {
+    atlas->platform->unmap_file(atlas->data, atlas->size);
+  }
+
+  cf_map_free(atlas->lookup);
+  *atlas = (Atlas){0};
+}
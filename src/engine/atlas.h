@@ -0,0 +1,98 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <cute_map.h>
+#include <cute_sprite.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// Cooked Sprite Atlas
+// =============================================================================
+// Sprites pre-packed by tools/cook_sprites (`rake cook`). The table is mapped
+// read-only and used in place: no Aseprite decoding, and the atlas pages are
+// registered with CF as premade atlases so nothing is packed at runtime.
+
+#define ATLAS_TABLE_PATH "assets/cooked/sprites.bin"
+#define ATLAS_MAGIC 0x50535454 // "TTSP"
+#define ATLAS_VERSION 1
+
+// Image ids handed to CF for cooked frames, clear of the ranges CF assigns
+#define ATLAS_IMAGE_ID_BASE (UINT64_C(1) << 62)
+
+typedef struct Platform Platform;
+
+// On-disk layout (little endian; sections follow each other in this order,
+// then the string block). String fields are byte offsets into it.
+typedef struct AtlasHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t page_count;
+  uint32_t sprite_count;
+  uint32_t animation_count;
+  uint32_t frame_count;
+  uint32_t strings_size;
+  uint32_t reserved;
+} AtlasHeader;
+
+typedef struct AtlasPage {
+  uint32_t path; // PNG in the CF filesystem
+  uint16_t w, h;
+} AtlasPage;
+
+typedef struct AtlasSprite {
+  uint32_t path; // Source .ase path, as passed to make_sprite
+  uint16_t w, h;
+  uint32_t first_frame;
+  uint32_t frame_count;
+  uint32_t first_animation;
+  uint32_t animation_count;
+} AtlasSprite;
+
+typedef struct AtlasAnimation {
+  uint32_t name;
+  uint32_t first_frame;
+  uint32_t frame_count;
+  uint32_t direction; // CF_PlayDirection
+} AtlasAnimation;
+
+// A sprite-sized cell of a page
+typedef struct AtlasFrame {
+  uint16_t page;
+  uint16_t x, y;
+  uint16_t delay_ms;
+} AtlasFrame;
+
+// CF animations built from the table on first use of a sprite
+typedef struct AtlasSpriteData {
+  CF_Animation* animations;
+  CF_MAP(const CF_Animation*) table; // Interned name -> animation
+} AtlasSpriteData;
+
+typedef struct Atlas {
+  Platform* platform;
+  const void* data; // Mapped table, nullptr when not open
+  size_t size;
+
+  const AtlasHeader* header;
+  const AtlasPage* pages;
+  const AtlasSprite* sprites;
+  const AtlasAnimation* animations;
+  const AtlasFrame* frames;
+  const char* strings;
+
+  CF_MAP(uint32_t) lookup; // Interned sprite path -> sprite index
+  AtlasSpriteData* built;  // One per sprite
+} Atlas;
+
+// Maps the table at `path` and registers its pages. Returns false, leaving the
+// atlas closed, if the file is missing or does not match this build.
+bool atlas_open(Atlas* atlas, Platform* platform, const char* path);
+void atlas_close(Atlas* atlas);
+
+// Makes a sprite for a cooked `path` (interned). Returns false if the atlas
+// does not contain it.
+bool atlas_make_sprite(Atlas* atlas, const char* path, CF_Sprite* out_sprite);
+
+#endif // ATLAS_H
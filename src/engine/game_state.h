@@ -1,20 +1,39 @@
 #pragma once
 
-#include <cute_alloc.h>
 #include <cute_graphics.h>
+#include <stdint.h>
 
+#include "arena.h"
+#include "asset.h"
 #include "world.h"
 
+// Bump when GameState or a struct it embeds changes layout. A reloaded library
+// can't reinterpret an older state, so the host keeps the running library when
+// game_state_layout differs (game_hot_reload refuses it too). Component
+// structs live in ECS storage and are migrated instead (see world.h).
+#define GAME_STATE_VERSION 10
+
 typedef struct Platform Platform;
 
 typedef struct GameState {
+  // Checked by game_hot_reload; keep these first
+  uint32_t version; // GAME_STATE_VERSION of the library that created it
+  uint32_t size;    // sizeof(GameState) in that library
+
   Platform* platform;
-  CF_Arena* scratch_arena;
+  Arena scratch_arena;   // Reset every game_update
+  FrameArena frame_arena; // Valid until the end of the next frame
 
   CF_Canvas canvas; // The main game canvas
 
   bool debug_mode;
 
+  // Presses latched each frame by game_render, taken by the next tick
+  uint8_t pending_input; // Player actions (read_input_bits)
+  uint8_t pending_keys;  // GameKey bits (game.c)
+
+  AssetCache assets; // Shared sprite data, referenced by C_Sprite
+
   World world;
 } GameState;
 
@@ -1,19 +1,47 @@
 #include "log.h"
 
+#include <SDL3/SDL_atomic.h>
 #include <SDL3/SDL_log.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
-void log_init(void) {
-#ifdef DEBUG
-  SDL_SetLogPriorities(SDL_LOG_PRIORITY_VERBOSE);
-#endif
-  log_debug("log", "Logging initialized.");
-}
+#define LOG_RING_SIZE 1024 // Power of two
+#define LOG_IDLE_WAIT_MS 10
 
-void log_write(LogLevel level, const char* tag, const char* file, int line,
-               const char* fmt, ...) {
+// Bounded MPSC queue (Vyukov): a slot's sequence equals its position when
+// free and position + 1 once its record is published.
+typedef struct LogRecord {
+  LogLevel level;
+  const char* tag;
+  const char* file;
+  int line;
+  char msg[LOG_MESSAGE_SIZE];
+} LogRecord;
+
+typedef struct LogSlot {
+  SDL_AtomicInt sequence;
+  LogRecord record;
+} LogSlot;
+
+static LogSlot ring[LOG_RING_SIZE];
+static SDL_AtomicInt ring_head; // Next position to claim (producers)
+static SDL_AtomicInt ring_tail; // Next position to write (writer)
+static SDL_AtomicInt dropped;
+static SDL_AtomicInt running;
+
+static SDL_Thread* writer        = nullptr;
+static SDL_Semaphore* wake       = nullptr;
+static LogSubmitFunction forward = nullptr;
+
+// =============================================================================
+// Output
+// =============================================================================
+
+static void log_output(const LogRecord* record) {
   // Map LogLevel to SDL_LogPriority
   static const SDL_LogPriority priorities[] = {
       [LOG_LEVEL_DEBUG] = SDL_LOG_PRIORITY_DEBUG,
@@ -24,6 +52,7 @@ void log_write(LogLevel level, const char* tag, const char* file, int line,
   };
 
   // Strip source directory prefix from file path
+  const char* file = record->file;
 #ifdef LOG_SOURCE_DIR
   static const size_t prefix_len = sizeof(LOG_SOURCE_DIR) - 1;
   if (strncmp(file, LOG_SOURCE_DIR, prefix_len) == 0) {
@@ -31,22 +60,184 @@ void log_write(LogLevel level, const char* tag, const char* file, int line,
   }
 #endif
 
-  // Format user message
-  char user_msg[1024];
+  // Format final message with file:line and optional tag
+  if (record->tag) {
+    SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, priorities[record->level],
+                   "[%s] %s:%d: %s", record->tag, file, record->line,
+                   record->msg);
+  } else {
+    SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, priorities[record->level],
+                   "%s:%d: %s", file, record->line, record->msg);
+  }
+}
+
+// =============================================================================
+// Ring
+// =============================================================================
+
+// Claims a slot for writing, or returns nullptr when the ring is full
+static LogSlot* ring_claim(int* position) {
+  int pos = SDL_GetAtomicInt(&ring_head);
+
+  while (true) {
+    LogSlot* slot = &ring[(unsigned)pos & (LOG_RING_SIZE - 1)];
+    int diff      = SDL_GetAtomicInt(&slot->sequence) - pos;
+
+    if (diff == 0) {
+      if (SDL_CompareAndSwapAtomicInt(&ring_head, pos, pos + 1)) {
+        *position = pos;
+        return slot;
+      }
+      pos = SDL_GetAtomicInt(&ring_head);
+    } else if (diff < 0) {
+      SDL_AddAtomicInt(&dropped, 1);
+      return nullptr;
+    } else {
+      pos = SDL_GetAtomicInt(&ring_head);
+    }
+  }
+}
+
+static void ring_publish(LogSlot* slot, int position) {
+  SDL_SetAtomicInt(&slot->sequence, position + 1);
+  SDL_SignalSemaphore(wake);
+}
+
+// Writes every published record. Writer thread only.
+static bool ring_drain(void) {
+  bool wrote = false;
+  int tail   = SDL_GetAtomicInt(&ring_tail);
+
+  while (true) {
+    LogSlot* slot = &ring[(unsigned)tail & (LOG_RING_SIZE - 1)];
+    if (SDL_GetAtomicInt(&slot->sequence) != tail + 1) {
+      break;
+    }
+
+    log_output(&slot->record);
+
+    // Free the slot for the producer one lap ahead
+    SDL_SetAtomicInt(&slot->sequence, tail + LOG_RING_SIZE);
+    SDL_SetAtomicInt(&ring_tail, ++tail);
+    wrote = true;
+  }
+
+  return wrote;
+}
+
+static int log_writer(void* udata [[maybe_unused]]) {
+  int reported_drops = 0;
+
+  while (SDL_GetAtomicInt(&running)) {
+    SDL_WaitSemaphoreTimeout(wake, LOG_IDLE_WAIT_MS);
+    ring_drain();
+
+    int drops = SDL_GetAtomicInt(&dropped);
+    if (drops != reported_drops) {
+      LogRecord record = {.level = LOG_LEVEL_WARN, .tag = "log",
+                          .file = __FILE__, .line = __LINE__};
+      snprintf(record.msg, sizeof(record.msg),
+               "Ring full, dropped %d messages", drops - reported_drops);
+      log_output(&record);
+      reported_drops = drops;
+    }
+  }
+
+  ring_drain();
+  return 0;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void log_init(void) {
+#ifdef DEBUG
+  SDL_SetLogPriorities(SDL_LOG_PRIORITY_VERBOSE);
+#endif
+
+  for (int i = 0; i < LOG_RING_SIZE; i++) {
+    SDL_SetAtomicInt(&ring[i].sequence, i);
+  }
+  SDL_SetAtomicInt(&ring_head, 0);
+  SDL_SetAtomicInt(&ring_tail, 0);
+  SDL_SetAtomicInt(&dropped, 0);
+
+  wake = SDL_CreateSemaphore(0);
+  SDL_SetAtomicInt(&running, 1);
+  writer = SDL_CreateThread(log_writer, "log_writer", nullptr);
+  if (!writer) {
+    SDL_SetAtomicInt(&running, 0); // Fall back to synchronous writes
+  }
+
+  log_debug("log", "Logging initialized.");
+}
+
+void log_shutdown(void) {
+  if (!writer) {
+    return;
+  }
+
+  SDL_SetAtomicInt(&running, 0);
+  SDL_SignalSemaphore(wake);
+  SDL_WaitThread(writer, nullptr);
+  SDL_DestroySemaphore(wake);
+  writer = nullptr;
+  wake   = nullptr;
+}
+
+void log_flush(void) {
+  if (!SDL_GetAtomicInt(&running)) {
+    return;
+  }
+
+  while (SDL_GetAtomicInt(&ring_tail) != SDL_GetAtomicInt(&ring_head)) {
+    SDL_SignalSemaphore(wake);
+    SDL_Delay(1);
+  }
+}
+
+int log_dropped_count(void) { return SDL_GetAtomicInt(&dropped); }
+
+void log_set_forward(LogSubmitFunction submit) { forward = submit; }
+
+void log_submit(LogLevel level, const char* tag, const char* file, int line,
+                const char* msg) {
+  // Synchronous without a writer, and for fatal errors (the process is about
+  // to go down, so flush what came before and write immediately)
+  if (!SDL_GetAtomicInt(&running) || level == LOG_LEVEL_FATAL) {
+    log_flush();
+
+    LogRecord record = {.level = level, .tag = tag, .file = file, .line = line};
+    snprintf(record.msg, sizeof(record.msg), "%s", msg);
+    log_output(&record);
+    return;
+  }
+
+  int position;
+  LogSlot* slot = ring_claim(&position);
+  if (!slot) {
+    return;
+  }
+
+  slot->record = (LogRecord){.level = level, .tag = tag, .file = file,
+                             .line = line};
+  snprintf(slot->record.msg, sizeof(slot->record.msg), "%s", msg);
+  ring_publish(slot, position);
+}
+
+void log_write(LogLevel level, const char* tag, const char* file, int line,
+               const char* fmt, ...) {
+  // Format user message (only the message; file:line is added when written)
+  char msg[LOG_MESSAGE_SIZE];
   va_list args;
   va_start(args, fmt);
-  vsnprintf(user_msg, sizeof(user_msg), fmt, args);
+  vsnprintf(msg, sizeof(msg), fmt, args);
   va_end(args);
 
-  // Format final message with file:line and optional tag
-  char final_msg[1280];
-  if (tag) {
-    snprintf(final_msg, sizeof(final_msg), "[%s] %s:%d: %s", tag, file, line,
-             user_msg);
+  if (forward) {
+    forward(level, tag, file, line, msg);
   } else {
-    snprintf(final_msg, sizeof(final_msg), "%s:%d: %s", file, line, user_msg);
+    log_submit(level, tag, file, line, msg);
   }
-
-  SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, priorities[level], "%s",
-                 final_msg);
 }
@@ -8,28 +8,67 @@ typedef enum {
   LOG_LEVEL_FATAL
 } LogLevel;
 
+// Calls below this level compile to nothing (0 = debug ... 4 = fatal).
+// Defaults to keeping everything in debug builds and dropping debug in release.
+#ifndef LOG_MIN_LEVEL
+#ifdef DEBUG
+#define LOG_MIN_LEVEL 0
+#else
+#define LOG_MIN_LEVEL 1
+#endif
+#endif
+
+// Queued messages are truncated to this many bytes
+#define LOG_MESSAGE_SIZE 512
+
+// Receives a formatted message. `tag` and `file` must outlive the call until
+// log_flush() (string literals do).
+typedef void (*LogSubmitFunction)(LogLevel level, const char* tag,
+                                  const char* file, int line, const char* msg);
+
 // Core function (called by macros)
 __attribute__((format(printf, 5, 6))) void log_write(LogLevel level,
                                                      const char* tag,
                                                      const char* file, int line,
                                                      const char* fmt, ...);
 
-// Initialize logging (sets up SDL log priorities in debug builds)
+// Initialize logging (sets up SDL log priorities in debug builds) and start
+// the writer thread. Messages are formatted on the caller, queued in a
+// lock-free ring and written to SDL_Log by the writer; FATAL is synchronous.
 void log_init(void);
 
+// Drain the queue and stop the writer thread.
+void log_shutdown(void);
+
+// Block until every queued message has been written.
+void log_flush(void);
+
+// Queue an already formatted message (exposed to the game through Platform).
+void log_submit(LogLevel level, const char* tag, const char* file, int line,
+                const char* msg);
+
+// Send this module's log_write calls to another module's log_submit. The game
+// library forwards to the host's queue so it never owns the writer thread.
+void log_set_forward(LogSubmitFunction forward);
+
+// Messages lost because the ring was full
+int log_dropped_count(void);
+
+// Stripped calls keep format checking but are never evaluated
+#define LOG_AT(level, min, tag, fmt, ...)                                      \
+  ((min) >= LOG_MIN_LEVEL                                                      \
+       ? log_write(level, tag, __FILE__, __LINE__,                             \
+                   fmt __VA_OPT__(, ) __VA_ARGS__)                             \
+       : (void)0)
+
 // Convenience macros with file/line capture
 #define log_debug(tag, fmt, ...)                                               \
-  log_write(LOG_LEVEL_DEBUG, tag, __FILE__, __LINE__,                          \
-            fmt __VA_OPT__(, ) __VA_ARGS__)
+  LOG_AT(LOG_LEVEL_DEBUG, 0, tag, fmt __VA_OPT__(, ) __VA_ARGS__)
 #define log_info(tag, fmt, ...)                                                \
-  log_write(LOG_LEVEL_INFO, tag, __FILE__, __LINE__,                           \
-            fmt __VA_OPT__(, ) __VA_ARGS__)
+  LOG_AT(LOG_LEVEL_INFO, 1, tag, fmt __VA_OPT__(, ) __VA_ARGS__)
 #define log_warn(tag, fmt, ...)                                                \
-  log_write(LOG_LEVEL_WARN, tag, __FILE__, __LINE__,                           \
-            fmt __VA_OPT__(, ) __VA_ARGS__)
+  LOG_AT(LOG_LEVEL_WARN, 2, tag, fmt __VA_OPT__(, ) __VA_ARGS__)
 #define log_error(tag, fmt, ...)                                               \
-  log_write(LOG_LEVEL_ERROR, tag, __FILE__, __LINE__,                          \
-            fmt __VA_OPT__(, ) __VA_ARGS__)
+  LOG_AT(LOG_LEVEL_ERROR, 3, tag, fmt __VA_OPT__(, ) __VA_ARGS__)
 #define log_fatal(tag, fmt, ...)                                               \
-  log_write(LOG_LEVEL_FATAL, tag, __FILE__, __LINE__,                          \
-            fmt __VA_OPT__(, ) __VA_ARGS__)
+  LOG_AT(LOG_LEVEL_FATAL, 4, tag, fmt __VA_OPT__(, ) __VA_ARGS__)
@@ -0,0 +1,203 @@
+#include "memory.h"
+
+#include <SDL3/SDL_atomic.h>
+#include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MEMORY_MAGIC 0x4D454D54u // "TMEM"
+
+// Prefix of every tracked block, padded so the block keeps malloc's alignment
+typedef struct MemoryHeader {
+  alignas(max_align_t) size_t size;
+  uint32_t tag;
+  uint32_t magic;
+} MemoryHeader;
+
+// Updated from any thread. Bytes are counted in an int: the game stays far
+// below 2 GiB.
+typedef struct MemoryCounters {
+  SDL_AtomicInt live_bytes;
+  SDL_AtomicInt peak_bytes;
+  SDL_AtomicInt live_blocks;
+  SDL_AtomicInt frame_allocs;
+  SDL_AtomicInt frame_frees;
+} MemoryCounters;
+
+#define MEMORY_TAG_NAME(ID, NAME) [ID] = NAME,
+
+static const char* memory_tag_names[MEMORY_TAG_COUNT] = {
+    MEMORY_TAGS(MEMORY_TAG_NAME)};
+
+#undef MEMORY_TAG_NAME
+
+static MemoryCounters counters[MEMORY_TAG_COUNT];
+static SDL_AtomicInt total_bytes;
+static SDL_AtomicInt total_peak;
+
+// Frame counters of the last completed frame (main thread)
+static int last_allocs[MEMORY_TAG_COUNT];
+static int last_frees[MEMORY_TAG_COUNT];
+
+static _Thread_local MemoryTag current_tag = MEMORY_TAG_OTHER;
+static MemoryTagFunction forward           = nullptr;
+
+// =============================================================================
+// Counters
+// =============================================================================
+
+static void memory_raise_peak(SDL_AtomicInt* peak, int value) {
+  int seen = SDL_GetAtomicInt(peak);
+  while (value > seen && !SDL_CompareAndSwapAtomicInt(peak, seen, value)) {
+    seen = SDL_GetAtomicInt(peak);
+  }
+}
+
+static void memory_add_bytes(MemoryCounters* tag, int delta) {
+  // SDL_AddAtomicInt returns the value before the add
+  int live = SDL_AddAtomicInt(&tag->live_bytes, delta) + delta;
+  memory_raise_peak(&tag->peak_bytes, live);
+
+  int total = SDL_AddAtomicInt(&total_bytes, delta) + delta;
+  memory_raise_peak(&total_peak, total);
+}
+
+static void* memory_track(MemoryHeader* header, size_t size) {
+  if (!header) {
+    return nullptr;
+  }
+
+  MemoryTag tag = current_tag;
+  *header = (MemoryHeader){.size = size, .tag = tag, .magic = MEMORY_MAGIC};
+
+  SDL_AddAtomicInt(&counters[tag].live_blocks, 1);
+  SDL_AddAtomicInt(&counters[tag].frame_allocs, 1);
+  memory_add_bytes(&counters[tag], (int)size);
+  return header + 1;
+}
+
+static MemoryHeader* memory_header(void* ptr) {
+  MemoryHeader* header = (MemoryHeader*)ptr - 1;
+  CF_ASSERT(header->magic == MEMORY_MAGIC); // Freed twice, or not ours
+  return header;
+}
+
+// =============================================================================
+// Allocator
+// =============================================================================
+
+static void* memory_alloc(size_t size, [[maybe_unused]] void* udata) {
+  if (size > SIZE_MAX - sizeof(MemoryHeader)) {
+    return nullptr;
+  }
+  return memory_track(malloc(sizeof(MemoryHeader) + size), size);
+}
+
+static void memory_free(void* ptr, [[maybe_unused]] void* udata) {
+  if (!ptr) {
+    return;
+  }
+
+  MemoryHeader* header = memory_header(ptr);
+  MemoryCounters* tag  = &counters[header->tag];
+
+  SDL_AddAtomicInt(&tag->live_blocks, -1);
+  SDL_AddAtomicInt(&tag->frame_frees, 1);
+  memory_add_bytes(tag, -(int)header->size);
+
+  header->magic = 0;
+  free(header);
+}
+
+static void* memory_calloc(size_t count, size_t size,
+                           [[maybe_unused]] void* udata) {
+  if (size != 0 && count > (SIZE_MAX - sizeof(MemoryHeader)) / size) {
+    return nullptr;
+  }
+
+  size_t bytes = count * size;
+  return memory_track(calloc(1, sizeof(MemoryHeader) + bytes), bytes);
+}
+
+// A block keeps the tag it was first allocated with
+static void* memory_realloc(void* ptr, size_t size,
+                            [[maybe_unused]] void* udata) {
+  if (!ptr) {
+    return memory_alloc(size, udata);
+  }
+  if (size > SIZE_MAX - sizeof(MemoryHeader)) {
+    return nullptr;
+  }
+
+  MemoryHeader* header = memory_header(ptr);
+  size_t old_size      = header->size;
+
+  header = realloc(header, sizeof(MemoryHeader) + size);
+  if (!header) {
+    return nullptr;
+  }
+  header->size = size;
+
+  MemoryCounters* tag = &counters[header->tag];
+  SDL_AddAtomicInt(&tag->frame_allocs, 1);
+  memory_add_bytes(tag, (int)size - (int)old_size);
+  return header + 1;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void memory_init(void) {
+  cf_allocator_override((CF_Allocator){
+      .alloc_fn   = memory_alloc,
+      .free_fn    = memory_free,
+      .calloc_fn  = memory_calloc,
+      .realloc_fn = memory_realloc,
+  });
+}
+
+void memory_end_frame(void) {
+  // SDL_SetAtomicInt returns the value it replaces
+  for (int i = 0; i < MEMORY_TAG_COUNT; i++) {
+    last_allocs[i] = SDL_SetAtomicInt(&counters[i].frame_allocs, 0);
+    last_frees[i]  = SDL_SetAtomicInt(&counters[i].frame_frees, 0);
+  }
+}
+
+void memory_get_stats(MemoryStats* stats) {
+  *stats = (MemoryStats){0};
+
+  for (int i = 0; i < MEMORY_TAG_COUNT; i++) {
+    MemoryTagStats* tag = &stats->tags[i];
+    tag->live_bytes     = (size_t)SDL_GetAtomicInt(&counters[i].live_bytes);
+    tag->peak_bytes     = (size_t)SDL_GetAtomicInt(&counters[i].peak_bytes);
+    tag->live_blocks    = SDL_GetAtomicInt(&counters[i].live_blocks);
+    tag->frame_allocs   = last_allocs[i];
+    tag->frame_frees    = last_frees[i];
+
+    stats->total.live_bytes += tag->live_bytes;
+    stats->total.live_blocks += tag->live_blocks;
+    stats->total.frame_allocs += tag->frame_allocs;
+    stats->total.frame_frees += tag->frame_frees;
+  }
+
+  stats->total.peak_bytes = (size_t)SDL_GetAtomicInt(&total_peak);
+}
+
+const char* memory_tag_name(MemoryTag tag) { return memory_tag_names[tag]; }
+
+MemoryTag memory_exchange_tag(MemoryTag tag) {
+  MemoryTag previous = current_tag;
+  current_tag        = tag;
+  return previous;
+}
+
+void memory_set_forward(MemoryTagFunction exchange) { forward = exchange; }
+
+MemoryTag memory_set_tag(MemoryTag tag) {
+  return forward ? forward(tag) : memory_exchange_tag(tag);
+}
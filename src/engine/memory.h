@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stddef.h>
+
+// =============================================================================
+// Memory Tracking
+// =============================================================================
+// The host installs a CF allocator that prefixes every block with its size and
+// the subsystem it was allocated for, so live bytes, high-water marks and
+// allocations per frame are known per tag. The tag is per thread: code that
+// owns an allocation sets it around the call (MEMORY_SCOPE), anything else
+// (CF internals, ImGui, jobs) counts as "other". In steady state a frame
+// should allocate nothing; the debug overlay and bench_world show when it
+// does.
+
+#define MEMORY_TAGS(X)                                                         \
+  X(MEMORY_TAG_OTHER, "other")                                                 \
+  X(MEMORY_TAG_ECS, "ecs")                                                     \
+  X(MEMORY_TAG_ASSETS, "assets")                                               \
+  X(MEMORY_TAG_ARENA, "arena")                                                 \
+  X(MEMORY_TAG_WORLD, "world")
+
+#define MEMORY_TAG_ENUM(ID, NAME) ID,
+
+typedef enum MemoryTag {
+  MEMORY_TAGS(MEMORY_TAG_ENUM) MEMORY_TAG_COUNT
+} MemoryTag;
+
+#undef MEMORY_TAG_ENUM
+
+typedef struct MemoryTagStats {
+  size_t live_bytes;
+  size_t peak_bytes; // Largest live_bytes since memory_init
+  int live_blocks;
+  int frame_allocs; // During the last completed frame, reallocs included
+  int frame_frees;
+} MemoryTagStats;
+
+typedef struct MemoryStats {
+  MemoryTagStats tags[MEMORY_TAG_COUNT];
+  MemoryTagStats total; // Sum of the tags; peak is of the sum
+} MemoryStats;
+
+// Sets the calling thread's tag and returns the previous one
+typedef MemoryTag (*MemoryTagFunction)(MemoryTag tag);
+
+// Installs the tracking allocator. Call before anything allocates through CF
+// (before cf_make_app), since blocks from the default allocator can't be
+// freed by it.
+void memory_init(void);
+
+// Closes the frame counters. Call once per displayed frame.
+void memory_end_frame(void);
+
+void memory_get_stats(MemoryStats* stats);
+
+const char* memory_tag_name(MemoryTag tag);
+
+// Host implementation of MemoryTagFunction (exposed through Platform)
+MemoryTag memory_exchange_tag(MemoryTag tag);
+
+// Send this module's memory_set_tag calls to the host's memory_exchange_tag.
+// The game library's copy of this file never sees an allocation itself.
+void memory_set_forward(MemoryTagFunction forward);
+
+// Tags the calling thread's allocations until set again; returns the
+// previous tag.
+MemoryTag memory_set_tag(MemoryTag tag);
+
+// Attributes allocations made by the enclosed statement(s) to TAG
+#define MEMORY_SCOPE(TAG, ...)                                                 \
+  do {                                                                         \
+    MemoryTag memory_tag_ = memory_set_tag(TAG);                               \
+    __VA_ARGS__;                                                               \
+    memory_set_tag(memory_tag_);                                               \
+  } while (0)
@@ -1,5 +1,55 @@
 #pragma once
 
+#include <cute_multithreading.h>
+#include <stddef.h>
+
+#include "log.h"
+#include "memory.h"
+
+// =============================================================================
+// Jobs
+// =============================================================================
+// The job system lives in the host executable, so its workers survive game
+// library reloads. Jobs hold game-library function pointers: every counter
+// must be waited on before the frame ends, and in game_prepare_reload, since
+// the library can be swapped between two ticks of a frame.
+
+typedef void (*JobFunction)(void* udata);
+typedef void (*JobRangeFunction)(void* udata, size_t begin, size_t end);
+
+// Number of unfinished jobs tracked by a wait. Zero-initialize before use.
+typedef struct JobCounter {
+  CF_AtomicInt pending;
+} JobCounter;
+
 typedef struct Platform {
   int (*get_system_page_size)(void);
+
+  // Worker threads, not counting the calling (main) thread
+  int (*job_worker_count)(void);
+
+  // Queues fn(udata). `counter` may be nullptr for fire-and-forget jobs.
+  void (*job_submit)(JobFunction fn, void* udata, JobCounter* counter);
+
+  // Splits [0, count) into ranges of at least min_batch (0 = one range).
+  void (*job_parallel_for)(size_t count, size_t min_batch, JobRangeFunction fn,
+                           void* udata, JobCounter* counter);
+
+  // Runs queued jobs on the calling thread until `counter` reaches zero.
+  void (*job_wait)(JobCounter* counter);
+
+  // Queues a formatted message on the host's log writer thread
+  LogSubmitFunction log_submit;
+
+  // Sets the calling thread's allocation tag in the host's tracker
+  MemoryTagFunction memory_tag;
+  void (*memory_stats)(MemoryStats* stats);
+
+  // Maps an asset ("assets/...") read-only; nullptr if it cannot be opened.
+  const void* (*map_file)(const char* path, size_t* size);
+  void (*unmap_file)(const void* data, size_t size);
+
+  // Input recording paths from --record/--replay, nullptr when not given
+  const char* record_input_path;
+  const char* replay_input_path;
 } Platform;
@@ -0,0 +1,148 @@
+#include "profiler.h"
+
+#include <SDL3/SDL_timer.h>
+#include <cute_multithreading.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+
+// Single-producer ring: the owning thread writes events and publishes them by
+// bumping `head`; profiler_frame() reads up to head and advances `tail`.
+typedef struct ProfileRing {
+  ProfileEvent events[PROFILER_RING_SIZE];
+  CF_AtomicInt head;
+  uint32_t tail;  // Main thread only
+  uint16_t depth; // Owning thread only
+} ProfileRing;
+
+static ProfileRing rings[PROFILER_MAX_THREADS];
+static CF_AtomicInt ring_count;
+
+static _Thread_local int thread_slot = -1;
+
+static ProfileEvent frame_events[PROFILER_FRAME_EVENTS];
+static float history[PROFILER_HISTORY];
+static ProfileFrame last_frame;
+static uint64_t frame_begin;
+
+// =============================================================================
+// Zones
+// =============================================================================
+
+static ProfileRing* thread_ring(void) {
+  if (thread_slot == -1) {
+    int slot    = cf_atomic_add(&ring_count, 1);
+    thread_slot = slot < PROFILER_MAX_THREADS ? slot : PROFILER_MAX_THREADS;
+
+    // Once per thread, since thread_slot is set from here on
+    if (slot >= PROFILER_MAX_THREADS) {
+      log_warn("profiler", "No ring for thread %d of %d, its zones are dropped",
+               slot + 1, PROFILER_MAX_THREADS);
+    }
+  }
+  return thread_slot < PROFILER_MAX_THREADS ? &rings[thread_slot] : nullptr;
+}
+
+ProfileZone profiler_begin(const char* name) {
+  ProfileRing* ring = thread_ring();
+  if (ring) {
+    ring->depth++;
+  }
+  return (ProfileZone){name, SDL_GetPerformanceCounter()};
+}
+
+void profiler_end(ProfileZone zone) {
+  uint64_t end      = SDL_GetPerformanceCounter();
+  ProfileRing* ring = thread_ring();
+  if (!ring) {
+    return; // More threads than slots
+  }
+
+  ring->depth--;
+
+  uint32_t head = (uint32_t)cf_atomic_get(&ring->head);
+  ring->events[head & (PROFILER_RING_SIZE - 1)] = (ProfileEvent){
+      .name   = zone.name,
+      .begin  = zone.begin,
+      .end    = end,
+      .depth  = ring->depth,
+      .thread = (uint16_t)thread_slot,
+  };
+  cf_atomic_set(&ring->head, (int)(head + 1));
+}
+
+// =============================================================================
+// Frames
+// =============================================================================
+
+static int compare_floats(const void* lhs, const void* rhs) {
+  float a = *(const float*)lhs;
+  float b = *(const float*)rhs;
+  return (a > b) - (a < b);
+}
+
+double profiler_ticks_to_ms(uint64_t ticks) {
+  return (double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+void profiler_frame(void) {
+  uint64_t now = SDL_GetPerformanceCounter();
+  if (frame_begin == 0) {
+    frame_begin = now;
+  }
+
+  // Drain every ring into the frame snapshot
+  int registered = cf_atomic_get(&ring_count);
+  int threads    = registered < PROFILER_MAX_THREADS ? registered
+                                                     : PROFILER_MAX_THREADS;
+
+  size_t count = 0;
+  for (int t = 0; t < threads; t++) {
+    ProfileRing* ring = &rings[t];
+    uint32_t head     = (uint32_t)cf_atomic_get(&ring->head);
+
+    // Writer lapped us: skip the overwritten events
+    if (head - ring->tail > PROFILER_RING_SIZE) {
+      ring->tail = head - PROFILER_RING_SIZE;
+    }
+
+    for (; ring->tail != head; ring->tail++) {
+      if (count < PROFILER_FRAME_EVENTS) {
+        frame_events[count++] =
+            ring->events[ring->tail & (PROFILER_RING_SIZE - 1)];
+      }
+    }
+  }
+
+  // Rolling frame time history and percentiles
+  float ms = (float)profiler_ticks_to_ms(now - frame_begin);
+  int slot = last_frame.history_offset;
+
+  history[slot]             = ms;
+  last_frame.history_offset = (slot + 1) % PROFILER_HISTORY;
+  if (last_frame.history_count < PROFILER_HISTORY) {
+    last_frame.history_count++;
+  }
+
+  float sorted[PROFILER_HISTORY];
+  int n = last_frame.history_count;
+  memcpy(sorted, history, (size_t)n * sizeof(float));
+  qsort(sorted, (size_t)n, sizeof(float), compare_floats);
+
+  last_frame.events          = frame_events;
+  last_frame.count           = count;
+  last_frame.begin           = frame_begin;
+  last_frame.end             = now;
+  last_frame.thread_count    = threads;
+  last_frame.dropped_threads = registered - threads;
+  last_frame.ms              = ms;
+  last_frame.p50             = sorted[(n - 1) / 2];
+  last_frame.p99             = sorted[(n - 1) * 99 / 100];
+  last_frame.history         = history;
+
+  frame_begin = now;
+}
+
+const ProfileFrame* profiler_last_frame(void) { return &last_frame; }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Instrumented CPU zones. Each thread records completed zones into its own
+// single-producer ring; the main thread drains all rings once per frame in
+// profiler_frame(). State lives in the game library and restarts on reload.
+
+#define PROFILER_MAX_THREADS 64 // JOBS_MAX_THREADS: main thread and workers
+#define PROFILER_RING_SIZE 4096   // Events per thread, power of two
+#define PROFILER_FRAME_EVENTS 4096 // Events kept for the last frame
+#define PROFILER_HISTORY 240       // Frame times kept for percentiles
+
+typedef struct ProfileZone {
+  const char* name;
+  uint64_t begin;
+} ProfileZone;
+
+typedef struct ProfileEvent {
+  const char* name; // Static string
+  uint64_t begin;   // Performance counter ticks
+  uint64_t end;
+  uint16_t depth;  // Nesting level on its thread
+  uint16_t thread; // Profiler thread slot
+} ProfileEvent;
+
+// Snapshot of the last completed frame
+typedef struct ProfileFrame {
+  const ProfileEvent* events;
+  size_t count;
+  uint64_t begin;
+  uint64_t end;
+  int thread_count;
+  int dropped_threads; // Threads past PROFILER_MAX_THREADS, not recorded
+
+  float ms;  // Duration of this frame
+  float p50; // Rolling percentiles over PROFILER_HISTORY frames
+  float p99;
+  const float* history; // Frame times in ms, oldest at history_offset
+  int history_count;
+  int history_offset;
+} ProfileFrame;
+
+ProfileZone profiler_begin(const char* name);
+void profiler_end(ProfileZone zone);
+
+// Closes the current frame. Call once per displayed frame on the main thread.
+void profiler_frame(void);
+const ProfileFrame* profiler_last_frame(void);
+
+double profiler_ticks_to_ms(uint64_t ticks);
+
+// Times the enclosed statement(s) as a zone named NAME
+#define PROFILE_ZONE(NAME, ...)                                                \
+  do {                                                                         \
+    ProfileZone profile_zone_ = profiler_begin(NAME);                          \
+    __VA_ARGS__;                                                               \
+    profiler_end(profile_zone_);                                               \
+  } while (0)
@@ -0,0 +1,152 @@
+// animation.c - Clip IDs and batched sprite playback
+//
+// Clips are stepped here in every play direction, carrying leftover time into
+// the next frame. cf_sprite_update would read CF's global delta instead of the
+// caller's dt, which LOD catch-up and bench_world depend on. A ping-pong pass
+// counts as a loop; the pass direction follows from loop_count.
+
+#include "animation.h"
+
+#include <cute_alloc.h>
+#include <cute_array.h>
+#include <cute_c_runtime.h>
+#include <cute_map.h>
+#include <cute_string.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ANIM_CLIP_NAME(ID, NAME) [ID] = NAME,
+
+static const char* anim_clip_names[ANIM_CLIP_COUNT] = {
+    ANIM_CLIPS(ANIM_CLIP_NAME)};
+
+#undef ANIM_CLIP_NAME
+
+// =============================================================================
+// Clip Tables
+// =============================================================================
+
+void animations_free(Animations* animations) {
+  cf_free(animations->sets);
+  *animations = (Animations){0};
+}
+
+void animations_invalidate(Animations* animations) {
+  cf_free(animations->sets);
+  animations->sets      = nullptr;
+  animations->set_count = 0;
+}
+
+const AnimClipSet* animations_resolve(Animations* animations,
+                                      const AssetCache* assets,
+                                      AssetHandle asset,
+                                      const CF_Sprite* sprite) {
+  CF_ASSERT(asset.id > 0);
+  size_t index = asset.id - 1;
+
+  if (index >= animations->set_count) {
+    size_t count = animations->set_count ? animations->set_count * 2 : 16;
+    while (count <= index) {
+      count *= 2;
+    }
+
+    animations->sets =
+        cf_realloc(animations->sets, count * sizeof(AnimClipSet));
+    CF_ASSERT(animations->sets);
+    memset(animations->sets + animations->set_count, 0,
+           (count - animations->set_count) * sizeof(AnimClipSet));
+    animations->set_count = count;
+  }
+
+  AnimClipSet* set    = &animations->sets[index];
+  uint32_t generation = asset_generation(assets, asset);
+  if (set->generation == generation) {
+    return set;
+  }
+
+  *set = (AnimClipSet){.generation = generation};
+  for (int clip = ANIM_CLIP_NONE + 1; clip < ANIM_CLIP_COUNT; clip++) {
+    uint64_t key = (uint64_t)(uintptr_t)cf_sintern(anim_clip_names[clip]);
+    if (sprite->animations && cf_map_has(sprite->animations, key)) {
+      set->clips[clip] = cf_map_get(sprite->animations, key);
+    }
+  }
+
+  return set;
+}
+
+// =============================================================================
+// Playback
+// =============================================================================
+
+// +1 or -1: the direction of the pass the sprite is in
+static int animation_step(const CF_Sprite* sprite) {
+  switch (sprite->animation->play_direction) {
+  case CF_PLAY_DIRECTION_BACKWARDS:
+    return -1;
+  case CF_PLAY_DIRECTION_PINGPONG:
+    return (sprite->loop_count & 1) ? -1 : 1;
+  default:
+    return 1;
+  }
+}
+
+int animation_first_frame(const CF_Animation* animation) {
+  if (animation->play_direction != CF_PLAY_DIRECTION_BACKWARDS) {
+    return 0;
+  }
+  int frame_count = cf_array_count(animation->frames);
+  return frame_count > 0 ? frame_count - 1 : 0;
+}
+
+bool animation_advance(CF_Sprite* sprite, float dt) {
+  const CF_Animation* animation = sprite->animation;
+  if (sprite->paused || !animation) {
+    return false;
+  }
+
+  int frame_count = cf_array_count(animation->frames);
+  if (frame_count == 0) {
+    return false;
+  }
+
+  bool finished = false;
+  sprite->t += dt * sprite->play_speed_multiplier;
+
+  // A long tick can cross several short frames
+  while (sprite->t >= animation->frames[sprite->frame_index].delay) {
+    float delay = animation->frames[sprite->frame_index].delay;
+    if (delay <= 0.0f) {
+      break;
+    }
+    sprite->t -= delay;
+
+    int step = animation_step(sprite);
+    int next = sprite->frame_index + step;
+    if (next >= 0 && next < frame_count) {
+      sprite->frame_index = next;
+      continue;
+    }
+
+    sprite->loop_count++;
+    finished = true;
+
+    if (!sprite->loop) {
+      // Hold the last frame; play_clip starts it again
+      sprite->t      = 0.0f;
+      sprite->paused = true;
+      break;
+    }
+
+    // Ping-pong turns around without showing the end frame twice
+    if (animation->play_direction == CF_PLAY_DIRECTION_PINGPONG) {
+      if (frame_count > 1) {
+        sprite->frame_index -= step;
+      }
+    } else {
+      sprite->frame_index = animation_first_frame(animation);
+    }
+  }
+
+  return finished;
+}
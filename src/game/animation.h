@@ -0,0 +1,80 @@
+// animation.h - Clip IDs and batched sprite playback
+//
+// Animation names are resolved once per loaded sprite asset into a table
+// indexed by AnimClip, so playing or comparing a clip is an array index and
+// an integer compare instead of a string intern plus map lookup. Timers for
+// every sprite are advanced in one pass (sys_advance_animations), which
+// queues an AnimEvent whenever a clip plays its last frame through.
+// Behaviours consume the queue rather than polling each sprite.
+
+#pragma once
+
+#include <cute_sprite.h>
+#include <pico_ecs.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../engine/asset.h"
+
+// Clips the game plays, with their name in the sprite files
+#define ANIM_CLIPS(X)                                                          \
+  X(ANIM_CLIP_GUN_AIM, "GunAim")                                               \
+  X(ANIM_CLIP_GUN_WALK, "GunWalk")                                             \
+  X(ANIM_CLIP_GUN_CROUCH, "GunCrouch")                                         \
+  X(ANIM_CLIP_GUN_FIRE, "GunFire")                                             \
+  X(ANIM_CLIP_GUN_WALK_FIRE, "GunWalkFire")                                    \
+  X(ANIM_CLIP_GUN_CROUCH_FIRE, "GunCrouchFire")                                \
+  X(ANIM_CLIP_GUN_RELOAD, "GunReload")
+
+#define ANIM_CLIP_ENUM(ID, NAME) ID,
+
+typedef enum AnimClip {
+  ANIM_CLIP_NONE, // Not started through play_clip, or missing from the sprite
+  ANIM_CLIPS(ANIM_CLIP_ENUM) ANIM_CLIP_COUNT
+} AnimClip;
+
+#undef ANIM_CLIP_ENUM
+
+// Clip table of one sprite asset. `generation` is the asset's when it was
+// resolved, so a released and reacquired slot is resolved again even for the
+// same path (its animations were unloaded with it).
+typedef struct AnimClipSet {
+  uint32_t generation;
+  const CF_Animation* clips[ANIM_CLIP_COUNT];
+} AnimClipSet;
+
+typedef struct AnimEvent {
+  ecs_entity_t entity;
+  AnimClip clip;
+} AnimEvent;
+
+typedef struct AnimEvents {
+  AnimEvent* items; // Tick arena
+  size_t count;
+  size_t capacity;
+} AnimEvents;
+
+typedef struct Animations {
+  AnimClipSet* sets; // Indexed by AssetHandle id - 1
+  size_t set_count;
+  AnimEvents finished; // Clips that finished this tick
+} Animations;
+
+void animations_free(Animations* animations);
+
+// Drops every resolved table; they are rebuilt on next use (hot reload,
+// where the clip list may have changed).
+void animations_invalidate(Animations* animations);
+
+// Resolves the clip table of a ready sprite asset, unless already done.
+const AnimClipSet* animations_resolve(Animations* animations,
+                                      const AssetCache* assets,
+                                      AssetHandle asset,
+                                      const CF_Sprite* sprite);
+
+// Frame a clip starts on in its play direction (the last one for backwards)
+int animation_first_frame(const CF_Animation* animation);
+
+// Advances one sprite by `dt`. Returns true when the clip played its last
+// frame through.
+bool animation_advance(CF_Sprite* sprite, float dt);
@@ -0,0 +1,59 @@
+// behavior.h - Stackless behaviour runtime
+//
+// Behaviour logic that used to block inside a coroutine ("play this animation
+// and wait until it finishes") stores its resume point and wait condition as
+// plain data instead. Every tick a behaviour either decides on a new action or
+// checks whether its wait is over, so many entities can be stepped in one
+// batch with no stack or context switch each, and state survives hot reloads.
+// Waits on a whole clip end through the AnimEvent queue (see animation.h).
+
+#pragma once
+
+#include <cute_sprite.h>
+#include <stdbool.h>
+
+#include "animation.h"
+
+typedef enum BehaviorWait {
+  BEHAVIOR_WAIT_NONE,      // Free to decide this tick
+  BEHAVIOR_WAIT_ANIMATION, // Until a finished event for `clip`
+  BEHAVIOR_WAIT_FRAME,     // Until the animation reaches `frame`
+  BEHAVIOR_WAIT_DONE,      // Released by an event, resumes this tick
+} BehaviorWait;
+
+typedef struct Behavior {
+  BehaviorWait wait;
+  int frame;     // Target frame for BEHAVIOR_WAIT_FRAME
+  int resume;    // Caller-defined state entered when the wait completes
+  AnimClip clip; // Clip for BEHAVIOR_WAIT_ANIMATION
+} Behavior;
+
+static inline void behavior_wait(Behavior* behavior, BehaviorWait wait,
+                                 AnimClip clip, int frame, int resume) {
+  behavior->wait   = wait;
+  behavior->clip   = clip;
+  behavior->frame  = frame;
+  behavior->resume = resume;
+}
+
+// Releases a wait on `clip`; called for each AnimEvent of the entity.
+static inline void behavior_clip_finished(Behavior* behavior, AnimClip clip) {
+  if (behavior->wait == BEHAVIOR_WAIT_ANIMATION && behavior->clip == clip) {
+    behavior->wait = BEHAVIOR_WAIT_DONE;
+  }
+}
+
+// True once the wait condition holds (always true when not waiting).
+static inline bool behavior_ready(const Behavior* behavior,
+                                  const CF_Sprite* sprite) {
+  switch (behavior->wait) {
+  case BEHAVIOR_WAIT_ANIMATION:
+    return false; // Until behavior_clip_finished
+  case BEHAVIOR_WAIT_FRAME:
+    return sprite->frame_index >= behavior->frame;
+  case BEHAVIOR_WAIT_DONE:
+  case BEHAVIOR_WAIT_NONE:
+  default:
+    return true;
+  }
+}
@@ -0,0 +1,132 @@
+// bodies.c - Structure-of-arrays kinematic bodies
+//
+// Storage management and the integration kernel for Bodies.
+
+#include "bodies.h"
+
+#include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <cute_math.h>
+#include <stddef.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define BODIES_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BODIES_NEON
+#endif
+
+// =============================================================================
+// Storage
+// =============================================================================
+
+static void bodies_reserve(Bodies* bodies, size_t capacity) {
+  bodies->x  = cf_realloc(bodies->x, capacity * sizeof(float));
+  bodies->y  = cf_realloc(bodies->y, capacity * sizeof(float));
+  bodies->vx = cf_realloc(bodies->vx, capacity * sizeof(float));
+  bodies->vy = cf_realloc(bodies->vy, capacity * sizeof(float));
+  bodies->entities =
+      cf_realloc(bodies->entities, capacity * sizeof(ecs_entity_t));
+  CF_ASSERT(bodies->x && bodies->y && bodies->vx && bodies->vy &&
+            bodies->entities);
+
+  bodies->capacity = capacity;
+}
+
+void bodies_init(Bodies* bodies, size_t capacity) {
+  *bodies = (Bodies){0};
+  bodies_reserve(bodies, capacity > 0 ? capacity : 1);
+}
+
+void bodies_free(Bodies* bodies) {
+  cf_free(bodies->x);
+  cf_free(bodies->y);
+  cf_free(bodies->vx);
+  cf_free(bodies->vy);
+  cf_free(bodies->entities);
+  *bodies = (Bodies){0};
+}
+
+size_t bodies_add(Bodies* bodies, ecs_entity_t entity, CF_V2 position,
+                  CF_V2 velocity) {
+  if (bodies->count == bodies->capacity) {
+    bodies_reserve(bodies, bodies->capacity * 2);
+  }
+
+  size_t row            = bodies->count++;
+  bodies->x[row]        = position.x;
+  bodies->y[row]        = position.y;
+  bodies->vx[row]       = velocity.x;
+  bodies->vy[row]       = velocity.y;
+  bodies->entities[row] = entity;
+
+  return row;
+}
+
+void bodies_resize(Bodies* bodies, size_t count) {
+  if (count > bodies->capacity) {
+    size_t capacity = bodies->capacity;
+    while (capacity < count) {
+      capacity *= 2;
+    }
+    bodies_reserve(bodies, capacity);
+  }
+
+  bodies->count = count;
+}
+
+ecs_entity_t bodies_remove(Bodies* bodies, size_t row) {
+  CF_ASSERT(row < bodies->count);
+
+  size_t last = --bodies->count;
+  if (row == last) {
+    return ecs_invalid_entity();
+  }
+
+  // Swap and remove (changes order of rows)
+  bodies->x[row]        = bodies->x[last];
+  bodies->y[row]        = bodies->y[last];
+  bodies->vx[row]       = bodies->vx[last];
+  bodies->vy[row]       = bodies->vy[last];
+  bodies->entities[row] = bodies->entities[last];
+
+  return bodies->entities[row];
+}
+
+// =============================================================================
+// Integration
+// =============================================================================
+
+static void integrate_axis(float* restrict p, const float* restrict v,
+                           size_t begin, size_t end, float dt) {
+  size_t i = begin;
+
+#if defined(BODIES_SSE2)
+  __m128 vdt = _mm_set1_ps(dt);
+  for (; i + 4 <= end; i += 4) {
+    __m128 pos = _mm_loadu_ps(p + i);
+    __m128 vel = _mm_loadu_ps(v + i);
+    _mm_storeu_ps(p + i, _mm_add_ps(pos, _mm_mul_ps(vel, vdt)));
+  }
+#elif defined(BODIES_NEON)
+  float32x4_t vdt = vdupq_n_f32(dt);
+  for (; i + 4 <= end; i += 4) {
+    float32x4_t pos = vld1q_f32(p + i);
+    float32x4_t vel = vld1q_f32(v + i);
+    vst1q_f32(p + i, vmlaq_f32(pos, vel, vdt));
+  }
+#endif
+
+  // Scalar tail (and fallback when no SIMD is available)
+  for (; i < end; i++) {
+    p[i] += v[i] * dt;
+  }
+}
+
+void bodies_integrate(Bodies* bodies, size_t begin, size_t end, float dt) {
+  CF_ASSERT(begin <= end && end <= bodies->count);
+
+  integrate_axis(bodies->x, bodies->vx, begin, end, dt);
+  integrate_axis(bodies->y, bodies->vy, begin, end, dt);
+}
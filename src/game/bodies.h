@@ -0,0 +1,46 @@
+// bodies.h - Structure-of-arrays kinematic bodies
+//
+// Bullets and crowd agents keep position and velocity in flat x[]/y[]/vx[]/vy[]
+// arrays instead of C_Transform/C_Velocity structs, so integration is a single
+// SIMD loop over contiguous floats. Entities reference their row via C_Body.
+
+#pragma once
+
+#include <cute_math.h>
+#include <pico_ecs.h>
+#include <stddef.h>
+
+typedef struct Bodies {
+  float* x;
+  float* y;
+  float* vx;
+  float* vy;
+  ecs_entity_t* entities; // Row -> owning entity
+  size_t count;
+  size_t capacity;
+} Bodies;
+
+// C_Body - Row of an entity in the world's Bodies arrays
+// Added with make_body; the row is released when the component is removed.
+typedef struct C_Body {
+  size_t row;
+} C_Body;
+
+void bodies_init(Bodies* bodies, size_t capacity);
+void bodies_free(Bodies* bodies);
+
+// Appends a body and returns its row.
+size_t bodies_add(Bodies* bodies, ecs_entity_t entity, CF_V2 position,
+                  CF_V2 velocity);
+
+// Sets the row count, growing storage as needed. Added rows are
+// uninitialized; snapshot_restore fills them.
+void bodies_resize(Bodies* bodies, size_t count);
+
+// Swap-removes a row. Returns the entity whose body moved into `row`, or an
+// invalid entity if `row` was the last one.
+ecs_entity_t bodies_remove(Bodies* bodies, size_t row);
+
+// position += velocity * dt for rows [begin, end), SSE2/NEON with a scalar
+// tail and fallback.
+void bodies_integrate(Bodies* bodies, size_t begin, size_t end, float dt);
@@ -0,0 +1,164 @@
+// collision.c - Collider broadphase and contact generation
+//
+// The grid only ever holds the layers that are looked for this tick
+// (hit_layers), and queries skip candidates outside the querying mask before
+// any shape test. Narrowphase uses CF's manifolds, so normals and depths
+// match the rest of the engine's geometry.
+
+#include "collision.h"
+
+#include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <cute_math.h>
+
+// =============================================================================
+// Lifecycle
+// =============================================================================
+
+void collisions_init(Collisions* collisions) {
+  *collisions = (Collisions){0};
+  spatial_init(&collisions->grid, COLLISION_CELL_SIZE, COLLISION_BUCKET_COUNT);
+}
+
+void collisions_free(Collisions* collisions) {
+  spatial_free(&collisions->grid);
+  cf_free(collisions->proxies);
+  cf_free(collisions->grid_proxies);
+  cf_free(collisions->candidates);
+  *collisions = (Collisions){0};
+}
+
+// =============================================================================
+// Proxies
+// =============================================================================
+
+void collisions_clear(Collisions* collisions) {
+  collisions->count      = 0;
+  collisions->contacts   = (Contacts){0};
+  collisions->pair_count = 0;
+}
+
+void collisions_add(Collisions* collisions, const ColliderProxy* proxy) {
+  if (collisions->count == collisions->capacity) {
+    size_t capacity      = collisions->capacity;
+    collisions->capacity = capacity ? capacity * 2 : 256;
+    collisions->proxies  = cf_realloc(
+        collisions->proxies, collisions->capacity * sizeof(ColliderProxy));
+    CF_ASSERT(collisions->proxies);
+  }
+
+  collisions->proxies[collisions->count++] = *proxy;
+}
+
+static CF_Aabb proxy_bounds(const ColliderProxy* proxy) {
+  return cf_make_aabb_center_half_extents(proxy->center, proxy->half_extents);
+}
+
+// =============================================================================
+// Narrowphase
+// =============================================================================
+
+bool collide_proxies(const ColliderProxy* a, const ColliderProxy* b,
+                     Contact* contact) {
+  CF_Manifold m = {0};
+
+  if (a->shape == COLLIDER_CIRCLE && b->shape == COLLIDER_CIRCLE) {
+    m = cf_circle_to_circle_manifold(
+        (CF_Circle){a->center, a->half_extents.x},
+        (CF_Circle){b->center, b->half_extents.x});
+  } else if (a->shape == COLLIDER_CIRCLE) {
+    m = cf_circle_to_aabb_manifold((CF_Circle){a->center, a->half_extents.x},
+                                   proxy_bounds(b));
+  } else if (b->shape == COLLIDER_CIRCLE) {
+    // Only circle-to-AABB exists; flip the normal back to a -> b
+    m   = cf_circle_to_aabb_manifold((CF_Circle){b->center, b->half_extents.x},
+                                     proxy_bounds(a));
+    m.n = cf_neg(m.n);
+  } else {
+    m = cf_aabb_to_aabb_manifold(proxy_bounds(a), proxy_bounds(b));
+  }
+
+  if (m.count == 0) {
+    return false;
+  }
+
+  *contact = (Contact){
+      .a      = a->entity,
+      .b      = b->entity,
+      .normal = m.n,
+      .point  = m.contact_points[0],
+      .depth  = m.depths[0],
+  };
+  return true;
+}
+
+// =============================================================================
+// Broadphase
+// =============================================================================
+
+static void collisions_reserve_grid(Collisions* collisions) {
+  if (collisions->count <= collisions->grid_capacity) {
+    return;
+  }
+
+  collisions->grid_capacity = collisions->capacity;
+  collisions->grid_proxies  = cf_realloc(
+      collisions->grid_proxies, collisions->grid_capacity * sizeof(uint32_t));
+  collisions->candidates = cf_realloc(
+      collisions->candidates, collisions->grid_capacity * sizeof(uint32_t));
+  CF_ASSERT(collisions->grid_proxies && collisions->candidates);
+}
+
+void collisions_detect(Collisions* collisions, Arena* arena) {
+  SpatialGrid* grid = &collisions->grid;
+  spatial_clear(grid);
+
+  uint32_t hit_layers = 0;
+  for (size_t i = 0; i < collisions->count; i++) {
+    hit_layers |= collisions->proxies[i].mask;
+  }
+
+  collisions_reserve_grid(collisions);
+
+  for (size_t i = 0; i < collisions->count; i++) {
+    const ColliderProxy* proxy = &collisions->proxies[i];
+    if (proxy->layer & hit_layers) {
+      collisions->grid_proxies[grid->count] = (uint32_t)i;
+      spatial_insert(grid, proxy->entity, proxy_bounds(proxy));
+    }
+  }
+
+  spatial_build(grid);
+
+  for (size_t i = 0; i < collisions->count; i++) {
+    const ColliderProxy* a = &collisions->proxies[i];
+    if (a->mask == 0) {
+      continue;
+    }
+
+    size_t found = spatial_query_items(grid, proxy_bounds(a),
+                                       collisions->candidates, grid->count);
+
+    for (size_t c = 0; c < found; c++) {
+      uint32_t item          = collisions->candidates[c];
+      uint32_t j             = collisions->grid_proxies[item];
+      const ColliderProxy* b = &collisions->proxies[j];
+
+      if (j == i || !(b->layer & a->mask)) {
+        continue;
+      }
+
+      // Mutual pair: the lower index reports it
+      if ((a->layer & b->mask) && j < i) {
+        continue;
+      }
+
+      collisions->pair_count++;
+
+      Contact contact;
+      if (collide_proxies(a, b, &contact)) {
+        ARENA_ARRAY_PUSH(arena, &collisions->contacts, contact);
+      }
+    }
+  }
+}
@@ -0,0 +1,90 @@
+// collision.h - Collider broadphase and contact generation
+//
+// Every tick the colliders are gathered into world-space proxies and those on
+// a layer some collider looks for are bucketed into a SpatialGrid of their
+// own (sized for bullets and hitboxes rather than sprites). Each collider
+// with a mask then queries the grid around itself, so the cost grows with
+// colliders times local density instead of colliders squared: thousands of
+// projectiles looking for targets never enter the grid or test each other.
+//
+// Contacts go to the world's tick arena and stay valid until the next tick.
+
+#pragma once
+
+#include <cute_math.h>
+#include <pico_ecs.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../engine/arena.h"
+#include "spatial.h"
+
+#define COLLISION_CELL_SIZE 32.0f
+#define COLLISION_BUCKET_COUNT 4096 // Power of two
+
+typedef enum ColliderShape {
+  COLLIDER_AABB,
+  COLLIDER_CIRCLE,
+} ColliderShape;
+
+// Bits for C_Collider layer and mask
+typedef enum CollisionLayer {
+  COLLISION_LAYER_PLAYER     = 1 << 0,
+  COLLISION_LAYER_PROJECTILE = 1 << 1,
+  COLLISION_LAYER_TARGET     = 1 << 2,
+} CollisionLayer;
+
+// A collider in world space for one tick
+typedef struct ColliderProxy {
+  ecs_entity_t entity;
+  ColliderShape shape;
+  CF_V2 center;
+  CF_V2 half_extents; // Circles: radius on both axes
+  uint32_t layer;
+  uint32_t mask;
+} ColliderProxy;
+
+// `a` was looking for `b`'s layer. Pairs where both look for each other are
+// reported once.
+typedef struct Contact {
+  ecs_entity_t a;
+  ecs_entity_t b;
+  CF_V2 normal; // From a towards b
+  CF_V2 point;
+  float depth; // Penetration along normal
+} Contact;
+
+typedef struct Contacts {
+  Contact* items; // Tick arena
+  size_t count;
+  size_t capacity;
+} Contacts;
+
+typedef struct Collisions {
+  SpatialGrid grid; // Proxies on a layer in some mask
+
+  ColliderProxy* proxies;
+  size_t count;
+  size_t capacity;
+
+  uint32_t* grid_proxies; // Grid item -> proxy index
+  uint32_t* candidates;   // Query results, one proxy's worth
+  size_t grid_capacity;
+
+  Contacts contacts;
+  size_t pair_count; // Pairs past the broadphase this tick
+} Collisions;
+
+void collisions_init(Collisions* collisions);
+void collisions_free(Collisions* collisions);
+
+// Per tick: clear, add every collider, then detect. Contacts are pushed to
+// `arena`, replacing the previous tick's.
+void collisions_clear(Collisions* collisions);
+void collisions_add(Collisions* collisions, const ColliderProxy* proxy);
+void collisions_detect(Collisions* collisions, Arena* arena);
+
+// Narrowphase for one pair; fills `contact` and returns true on overlap.
+bool collide_proxies(const ColliderProxy* a, const ColliderProxy* b,
+                     Contact* contact);
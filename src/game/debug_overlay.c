@@ -0,0 +1,222 @@
+// debug_overlay.c - ImGui debug overlay
+//
+// Shown while debug_mode is on (toggle with G). Draws the profiler's frame
+// time history with rolling p50/p99, a per-thread timeline of the last
+// frame's zones, and arena and ECS pool usage against capacity.
+
+#include "debug_overlay.h"
+
+#include <dcimgui.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../engine/arena.h"
+#include "../engine/game_state.h"
+#include "../engine/memory.h"
+#include "../engine/platform.h"
+#include "../engine/profiler.h"
+#include "ecs_pool.h"
+
+#define FRAME_BUDGET_MS (1000.0f / 60.0f)
+#define TIMELINE_ROW_HEIGHT 14.0f
+
+// Zone colors cycle by nesting depth
+static const ImU32 zone_colors[] = {
+    IM_COL32(86, 156, 214, 255),
+    IM_COL32(78, 201, 176, 255),
+    IM_COL32(220, 170, 90, 255),
+    IM_COL32(197, 134, 192, 255),
+};
+
+static void draw_timeline(const ProfileFrame* frame) {
+  uint64_t span = frame->end - frame->begin;
+  if (span == 0) {
+    return;
+  }
+
+  // Deepest zone per thread decides the row count
+  int depth[PROFILER_MAX_THREADS] = {0};
+  for (size_t i = 0; i < frame->count; i++) {
+    const ProfileEvent* e = &frame->events[i];
+    if (e->depth + 1 > depth[e->thread]) {
+      depth[e->thread] = e->depth + 1;
+    }
+  }
+
+  int row_offset[PROFILER_MAX_THREADS] = {0};
+  int rows                             = 0;
+  for (int t = 0; t < frame->thread_count; t++) {
+    row_offset[t] = rows;
+    rows += depth[t] > 0 ? depth[t] : 1;
+  }
+
+  ImDrawList* draw = ImGui_GetWindowDrawList();
+  ImVec2 origin    = ImGui_GetCursorScreenPos();
+  float width      = ImGui_GetContentRegionAvail().x;
+  float scale      = width / (float)span;
+
+  ImGui_Dummy((ImVec2){width, (float)rows * TIMELINE_ROW_HEIGHT});
+
+  for (size_t i = 0; i < frame->count; i++) {
+    const ProfileEvent* e = &frame->events[i];
+    uint64_t begin = e->begin > frame->begin ? e->begin - frame->begin : 0;
+    uint64_t end   = e->end > frame->begin ? e->end - frame->begin : 0;
+    end            = end < span ? end : span;
+
+    float y   = origin.y + (float)(row_offset[e->thread] + e->depth) *
+                             TIMELINE_ROW_HEIGHT;
+    ImVec2 p0 = {origin.x + (float)begin * scale, y};
+    ImVec2 p1 = {origin.x + (float)end * scale + 1.0f,
+                 y + TIMELINE_ROW_HEIGHT - 1.0f};
+
+    ImU32 color = zone_colors[e->depth % (sizeof(zone_colors) /
+                                          sizeof(zone_colors[0]))];
+    ImDrawList_AddRectFilled(draw, p0, p1, color);
+
+    // Label zones wide enough to fit some text
+    if (p1.x - p0.x > 40.0f) {
+      ImDrawList_AddText(draw, (ImVec2){p0.x + 2.0f, p0.y},
+                         IM_COL32(0, 0, 0, 255), e->name);
+    }
+
+    if (ImGui_IsMouseHoveringRect(p0, p1)) {
+      ImGui_SetTooltip("%s (T%u)\n%.3f ms", e->name, (unsigned)e->thread,
+                       profiler_ticks_to_ms(e->end - e->begin));
+    }
+  }
+}
+
+#define PHASE_NAME(ID, NAME) [ID] = NAME,
+#define LOD_LEVEL_NAME(ID, NAME, INTERVAL) [ID] = NAME,
+
+static const char* phase_names[WORLD_PHASE_COUNT] = {WORLD_PHASES(PHASE_NAME)};
+static const char* lod_level_names[LOD_LEVEL_COUNT] = {
+    LOD_LEVELS(LOD_LEVEL_NAME)};
+
+#undef PHASE_NAME
+#undef LOD_LEVEL_NAME
+
+// Bar fills to the current frame's usage; the label carries the high-water
+// mark, which is what the arena size has to cover
+static void draw_arena(const Arena* arena) {
+  char label[96];
+  snprintf(label, sizeof(label), "%s: %zu / %zu KB (peak %zu KB)",
+           arena->name, arena->used / 1024, arena->capacity / 1024,
+           arena->high_water / 1024);
+
+  float fraction = (float)arena->used / (float)arena->capacity;
+  ImGui_ProgressBar(fraction, (ImVec2){-1.0f, 0.0f}, label);
+}
+
+static void draw_ecs_pool(const EcsPool* pool) {
+  char label[112];
+  snprintf(label, sizeof(label),
+           "ecs: %zu / %zu KB (peak %zu KB), %zu realloc copies",
+           pool->live / 1024, pool->reserved / 1024, pool->high_water / 1024,
+           pool->copies);
+
+  float fraction = (float)pool->live / (float)pool->reserved;
+  ImGui_ProgressBar(fraction, (ImVec2){-1.0f, 0.0f}, label);
+}
+
+// Heap by tag. Allocations per frame should stay at zero once the level runs.
+static void draw_heap(const MemoryStats* stats) {
+  const MemoryTagStats* total = &stats->total;
+  ImGui_Text("heap: %zu KB (peak %zu KB), %d blocks, %d allocs %d frees",
+             total->live_bytes / 1024, total->peak_bytes / 1024,
+             total->live_blocks, total->frame_allocs, total->frame_frees);
+
+  for (int i = 0; i < MEMORY_TAG_COUNT; i++) {
+    const MemoryTagStats* tag = &stats->tags[i];
+    ImGui_Text("  %-6s %6zu KB (peak %6zu KB) %6d blocks  +%d -%d",
+               memory_tag_name((MemoryTag)i), tag->live_bytes / 1024,
+               tag->peak_bytes / 1024, tag->live_blocks, tag->frame_allocs,
+               tag->frame_frees);
+  }
+}
+
+// Phase toggles pause parts of the update (e.g. animation) while the rest runs.
+// They aren't recorded, so they are locked during input record/replay.
+static void draw_systems(World* world) {
+  ImGui_BeginDisabled(world->replay.mode != INPUT_REPLAY_OFF);
+  for (int i = 0; i < WORLD_PHASE_COUNT; i++) {
+    bool enabled = (world->phases & WORLD_PHASE_BIT(i)) != 0;
+    if (i > 0) {
+      ImGui_SameLine();
+    }
+    if (ImGui_Checkbox(phase_names[i], &enabled)) {
+      world->phases ^= WORLD_PHASE_BIT(i);
+    }
+  }
+  ImGui_EndDisabled();
+
+  ImGui_Text("LOD: %d due of", cf_atomic_get(&world->lod.due));
+  for (int i = 0; i < LOD_LEVEL_COUNT; i++) {
+    ImGui_SameLine();
+    ImGui_Text("%d %s", cf_atomic_get(&world->lod.entities[i]),
+               lod_level_names[i]);
+  }
+}
+
+void debug_overlay_draw(void) {
+  const ProfileFrame* frame = profiler_last_frame();
+  if (frame->history_count == 0) {
+    return;
+  }
+
+  ImGui_SetNextWindowPos((ImVec2){10.0f, 10.0f}, ImGuiCond_FirstUseEver);
+  ImGui_SetNextWindowSize((ImVec2){520.0f, 0.0f}, ImGuiCond_FirstUseEver);
+
+  if (ImGui_Begin("Profiler", nullptr, ImGuiWindowFlags_None)) {
+    ImGui_Text("Frame %.2f ms   p50 %.2f ms   p99 %.2f ms   budget %.2f ms",
+               (double)frame->ms, (double)frame->p50, (double)frame->p99,
+               (double)FRAME_BUDGET_MS);
+    if (frame->dropped_threads > 0) {
+      ImGui_Text("%d threads over the profiler limit are not shown",
+                 frame->dropped_threads);
+    }
+
+    ImGui_PlotLinesEx("##frame_times", frame->history, frame->history_count,
+                      frame->history_offset, nullptr, 0.0f,
+                      FRAME_BUDGET_MS * 2.0f, (ImVec2){0.0f, 60.0f},
+                      sizeof(float));
+
+    ImGui_SeparatorText("Timeline");
+    draw_timeline(frame);
+
+    ImGui_SeparatorText("Memory");
+    draw_arena(&state->scratch_arena);
+    draw_arena(frame_arena_current(&state->frame_arena));
+    draw_arena(&state->world.tick_arena);
+    draw_ecs_pool(&state->world.ecs_pool);
+
+    MemoryStats memory;
+    state->platform->memory_stats(&memory);
+    draw_heap(&memory);
+
+    // Pairs is what the broadphase let through; far below colliders squared
+    const Collisions* collisions = &state->world.collisions;
+    ImGui_SeparatorText("Collision");
+    ImGui_Text("%zu colliders (%zu in grid)   %zu pairs   %zu contacts",
+               collisions->count, collisions->grid.count,
+               collisions->pair_count, collisions->contacts.count);
+
+    ImGui_SeparatorText("Systems");
+    draw_systems(&state->world);
+
+    const Tilemap* tilemap = &state->world.tilemap;
+    ImGui_SeparatorText("Tilemap");
+    ImGui_Text("%dx%d tiles   %d chunks drawn   %d baked this frame",
+               tilemap->width, tilemap->height, tilemap->visible_chunks,
+               tilemap->baked_chunks);
+
+    const SnapshotHistory* history = &state->world.history;
+    ImGui_SeparatorText("Snapshot");
+    ImGui_Text("%zu bytes   quicksave %zu bytes", history->latest.size,
+               state->world.quicksave.size);
+    ImGui_Text("Rewind: %zu ticks in %.1f KB of deltas", history->count,
+               (double)history->delta_bytes / 1024.0);
+  }
+  ImGui_End();
+}
@@ -0,0 +1,7 @@
+// debug_overlay.h - ImGui debug overlay
+
+#pragma once
+
+// Draws the debug windows for this frame. Call between frames while
+// debug_mode is on.
+void debug_overlay_draw(void);
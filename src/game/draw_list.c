@@ -0,0 +1,86 @@
+// draw_list.c - Double-buffered sprite draw commands
+//
+// Replay touches neither the ECS nor the asset cache. The draw state stack
+// is left untouched: each command draws a copy of its sprite with the
+// translation folded into the sprite transform.
+
+#include "draw_list.h"
+
+#include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <cute_draw.h>
+
+#include "../engine/memory.h"
+
+void draw_lists_free(DrawLists* lists, Platform* platform) {
+  draw_lists_finish(lists, platform);
+
+  for (int i = 0; i < 2; i++) {
+    cf_free(lists->lists[i].sprites);
+    cf_free(lists->lists[i].entities);
+  }
+  *lists = (DrawLists){0};
+}
+
+static void draw_list_reserve(DrawList* list, size_t count) {
+  if (count <= list->capacity) {
+    return;
+  }
+
+  size_t capacity = list->capacity ? list->capacity * 2 : 256;
+  while (capacity < count) {
+    capacity *= 2;
+  }
+
+  MemoryTag tag  = memory_set_tag(MEMORY_TAG_WORLD);
+  list->sprites  = cf_realloc(list->sprites, capacity * sizeof(DrawSprite));
+  list->entities = cf_realloc(list->entities, capacity * sizeof(ecs_entity_t));
+  memory_set_tag(tag);
+
+  CF_ASSERT(list->sprites && list->entities);
+  list->capacity = capacity;
+}
+
+void draw_lists_record(DrawLists* lists, Platform* platform, size_t capacity,
+                       JobFunction fn) {
+  CF_ASSERT(!lists->recording);
+
+  DrawList* back = &lists->lists[lists->front ^ 1];
+  draw_list_reserve(back, capacity);
+  back->count = 0;
+
+  // No job system (headless tools): record in place
+  if (!platform || !platform->job_submit) {
+    fn(back);
+    lists->front ^= 1;
+    return;
+  }
+
+  lists->counter   = (JobCounter){0};
+  lists->recording = true;
+  platform->job_submit(fn, back, &lists->counter);
+}
+
+void draw_lists_finish(DrawLists* lists, Platform* platform) {
+  if (!lists->recording) {
+    return;
+  }
+
+  platform->job_wait(&lists->counter);
+  lists->recording = false;
+  lists->front ^= 1;
+}
+
+void draw_lists_replay(const DrawLists* lists, float alpha) {
+  const DrawList* list = &lists->lists[lists->front];
+
+  for (size_t i = 0; i < list->count; i++) {
+    const DrawSprite* command = &list->sprites[i];
+
+    CF_V2 position = cf_lerp_v2(command->previous, command->position, alpha);
+
+    CF_Sprite sprite   = command->sprite;
+    sprite.transform.p = cf_add(sprite.transform.p, position);
+    cf_draw_sprite(&sprite);
+  }
+}
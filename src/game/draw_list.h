@@ -0,0 +1,62 @@
+// draw_list.h - Double-buffered sprite draw commands
+//
+// After each tick, the visible sprites are recorded into a flat command list
+// on the job system. Each frame, the main thread replays the list through CF.
+// A command copies everything its draw needs: the sprite's playback state, its
+// layer, and the two positions to interpolate between. So a finished list
+// doesn't depend on the world. A frame without a tick replays the last list at
+// its new alpha.
+//
+// CF's draw API, the GPU device and the window belong to the main thread, and
+// the simulation runs inside cf_app_update there too. So only the recording
+// leaves it. The job overlaps with the rest of the frame (event pumping, chunk
+// baking, canvas clears). It is joined before the next tick changes the world,
+// in render_world, and before a hot reload unloads the library whose code it
+// runs (game_prepare_reload), which can happen between two ticks of a frame.
+
+#pragma once
+
+#include <cute_math.h>
+#include <cute_sprite.h>
+#include <pico_ecs.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../engine/platform.h"
+
+typedef struct DrawSprite {
+  CF_Sprite sprite; // Copy with the entity's playback state
+  CF_V2 previous;   // Position at the start of the tick
+  CF_V2 position;
+  uint32_t layer; // SpriteLayer
+  uint32_t order; // Record order, keeps the sort stable
+} DrawSprite;
+
+typedef struct DrawList {
+  DrawSprite* sprites;    // Sorted by layer, then source sprite
+  ecs_entity_t* entities; // Scratch of the recording job, same capacity
+  size_t count;
+  size_t capacity;
+} DrawList;
+
+typedef struct DrawLists {
+  DrawList lists[2];
+  uint32_t front;     // Index of the list replayed; the other one is recorded
+  bool recording;     // A job is filling the back list
+  JobCounter counter; // Of that job
+} DrawLists;
+
+void draw_lists_free(DrawLists* lists, Platform* platform);
+
+// Queues fn(back list) on the job system. The job fills at most `capacity`
+// commands, reserved here so it never allocates; the previous recording must
+// be finished.
+void draw_lists_record(DrawLists* lists, Platform* platform, size_t capacity,
+                       JobFunction fn);
+
+// Waits for a pending recording and makes it the front list.
+void draw_lists_finish(DrawLists* lists, Platform* platform);
+
+// Draws the front list, positions interpolated by `alpha` (0..1).
+void draw_lists_replay(const DrawLists* lists, float alpha);
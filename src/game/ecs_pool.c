@@ -0,0 +1,223 @@
+// ecs_pool.c - Pooled memory context for pico_ecs
+//
+// Every chunk starts with a header recording its size class, so free and
+// realloc need no lookup. Blocks are only returned in ecs_pool_free.
+
+#include "ecs_pool.h"
+
+#include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../engine/memory.h"
+
+// Minimum size of blocks added after the initial reserve
+#define ECS_POOL_BLOCK_PAGES 64
+
+// size_class of chunks allocated individually with cf_alloc
+#define ECS_POOL_LARGE UINT32_MAX
+
+typedef struct EcsPoolHeader {
+  alignas(max_align_t) size_t size; // Requested size, large chunks only
+  uint32_t size_class;
+} EcsPoolHeader;
+
+struct EcsPoolBlock {
+  EcsPoolBlock* next;
+  size_t size;
+  alignas(max_align_t) uint8_t data[];
+};
+
+// =============================================================================
+// Size Classes
+// =============================================================================
+
+static uint32_t ecs_pool_class(size_t size) {
+  uint32_t size_class = 0;
+  while (((size_t)1 << (size_class + ECS_POOL_MIN_CLASS_SHIFT)) < size) {
+    size_class++;
+  }
+  return size_class < ECS_POOL_CLASS_COUNT ? size_class : ECS_POOL_LARGE;
+}
+
+static size_t ecs_pool_class_size(uint32_t size_class) {
+  return (size_t)1 << (size_class + ECS_POOL_MIN_CLASS_SHIFT);
+}
+
+static size_t ecs_pool_chunk_size(uint32_t size_class) {
+  return sizeof(EcsPoolHeader) + ecs_pool_class_size(size_class);
+}
+
+static void ecs_pool_track(EcsPool* pool, size_t added) {
+  pool->live += added;
+  if (pool->live > pool->high_water) {
+    pool->high_water = pool->live;
+  }
+}
+
+// =============================================================================
+// Blocks
+// =============================================================================
+
+static void ecs_pool_push_free(EcsPool* pool, EcsPoolHeader* header) {
+  *(void**)(header + 1)                = pool->free_lists[header->size_class];
+  pool->free_lists[header->size_class] = header;
+}
+
+// Cuts what is left of the head block into free chunks, largest first, so
+// moving to a new block wastes at most one minimum-size chunk
+static void ecs_pool_spill_tail(EcsPool* pool) {
+  for (uint32_t size_class = ECS_POOL_CLASS_COUNT; size_class-- > 0;) {
+    size_t chunk = ecs_pool_chunk_size(size_class);
+
+    while ((size_t)(pool->limit - pool->cursor) >= chunk) {
+      EcsPoolHeader* header = (EcsPoolHeader*)pool->cursor;
+      header->size_class    = size_class;
+      pool->cursor += chunk;
+      ecs_pool_push_free(pool, header);
+    }
+  }
+}
+
+static void ecs_pool_push_block(EcsPool* pool, size_t min_size) {
+  size_t pages = (sizeof(EcsPoolBlock) + min_size + pool->page_size - 1) /
+                 pool->page_size;
+  if (pages < ECS_POOL_BLOCK_PAGES) {
+    pages = ECS_POOL_BLOCK_PAGES;
+  }
+
+  size_t size = pages * pool->page_size;
+
+  EcsPoolBlock* block;
+  MEMORY_SCOPE(MEMORY_TAG_ECS, block = cf_alloc(size));
+  CF_ASSERT(block != nullptr);
+
+  block->next  = pool->blocks;
+  block->size  = size;
+  pool->blocks = block;
+  pool->cursor = block->data;
+  pool->limit  = (uint8_t*)block + size;
+  pool->reserved += size;
+}
+
+// =============================================================================
+// Lifetime
+// =============================================================================
+
+void ecs_pool_init(EcsPool* pool, size_t page_size, size_t reserve) {
+  *pool = (EcsPool){.page_size = page_size > 0 ? page_size : 4096};
+  ecs_pool_push_block(pool, reserve);
+}
+
+void ecs_pool_free(EcsPool* pool) {
+  EcsPoolBlock* block = pool->blocks;
+  while (block) {
+    EcsPoolBlock* next = block->next;
+    cf_free(block);
+    block = next;
+  }
+  *pool = (EcsPool){0};
+}
+
+// =============================================================================
+// Allocation
+// =============================================================================
+
+void* ecs_pool_alloc(EcsPool* pool, size_t size) {
+  uint32_t size_class = ecs_pool_class(size);
+  EcsPoolHeader* header;
+
+  if (size_class == ECS_POOL_LARGE) {
+    MEMORY_SCOPE(MEMORY_TAG_ECS,
+                 header = cf_alloc(sizeof(EcsPoolHeader) + size));
+    CF_ASSERT(header != nullptr);
+    header->size       = size;
+    header->size_class = ECS_POOL_LARGE;
+    pool->reserved += size;
+    ecs_pool_track(pool, size);
+    return header + 1;
+  }
+
+  if (pool->free_lists[size_class]) {
+    header                       = pool->free_lists[size_class];
+    pool->free_lists[size_class] = *(void**)(header + 1);
+  } else {
+    size_t chunk = ecs_pool_chunk_size(size_class);
+    if ((size_t)(pool->limit - pool->cursor) < chunk) {
+      ecs_pool_spill_tail(pool);
+      ecs_pool_push_block(pool, chunk);
+    }
+
+    header             = (EcsPoolHeader*)pool->cursor;
+    header->size_class = size_class;
+    pool->cursor += chunk;
+  }
+
+  ecs_pool_track(pool, ecs_pool_class_size(size_class));
+  return header + 1;
+}
+
+void* ecs_pool_realloc(EcsPool* pool, void* ptr, size_t size) {
+  if (!ptr) {
+    return ecs_pool_alloc(pool, size);
+  }
+
+  EcsPoolHeader* header = (EcsPoolHeader*)ptr - 1;
+
+  if (header->size_class == ECS_POOL_LARGE) {
+    pool->reserved -= header->size;
+    pool->live -= header->size;
+
+    header = cf_realloc(header, sizeof(EcsPoolHeader) + size);
+    CF_ASSERT(header != nullptr);
+    header->size = size;
+    pool->reserved += size;
+    ecs_pool_track(pool, size);
+    return header + 1;
+  }
+
+  size_t old_size = ecs_pool_class_size(header->size_class);
+  if (size <= old_size) {
+    return ptr;
+  }
+
+  // Newest chunk of the head block: grow into the space after it
+  uint32_t size_class = ecs_pool_class(size);
+  if (size_class != ECS_POOL_LARGE &&
+      (uint8_t*)ptr + old_size == pool->cursor) {
+    size_t extra = ecs_pool_class_size(size_class) - old_size;
+    if (extra <= (size_t)(pool->limit - pool->cursor)) {
+      header->size_class = size_class;
+      pool->cursor += extra;
+      ecs_pool_track(pool, extra);
+      return ptr;
+    }
+  }
+
+  void* moved = ecs_pool_alloc(pool, size);
+  memcpy(moved, ptr, old_size);
+  ecs_pool_release(pool, ptr);
+  pool->copies++;
+  return moved;
+}
+
+void ecs_pool_release(EcsPool* pool, void* ptr) {
+  if (!ptr) {
+    return;
+  }
+
+  EcsPoolHeader* header = (EcsPoolHeader*)ptr - 1;
+
+  if (header->size_class == ECS_POOL_LARGE) {
+    pool->reserved -= header->size;
+    pool->live -= header->size;
+    cf_free(header);
+    return;
+  }
+
+  pool->live -= ecs_pool_class_size(header->size_class);
+  ecs_pool_push_free(pool, header);
+}
@@ -0,0 +1,43 @@
+// ecs_pool.h - Pooled memory context for pico_ecs
+//
+// Passed to ecs_new as mem_ctx (see the PICO_ECS_* hooks in world.c). Requests
+// are rounded up to power-of-two size classes and carved from page-multiple
+// blocks, with a free list per class. The first block is reserved up front for
+// ECS_ENTITY_COUNT entities, and a realloc that still fits its class (or is
+// the newest chunk of its block) returns the same pointer, so spawn bursts
+// rarely copy or reach the system allocator.
+//
+// Not thread-safe: structural ECS changes only happen on the main thread.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct EcsPoolBlock EcsPoolBlock;
+
+// 16 bytes .. 1 MB; larger requests go straight to cf_alloc
+#define ECS_POOL_MIN_CLASS_SHIFT 4
+#define ECS_POOL_CLASS_COUNT 17
+
+typedef struct EcsPool {
+  size_t page_size;
+  EcsPoolBlock* blocks; // Newest first; the head is being carved
+  uint8_t* cursor;      // Next free byte of the head block
+  uint8_t* limit;       // End of the head block
+  void* free_lists[ECS_POOL_CLASS_COUNT];
+
+  // Stats for the debug overlay
+  size_t reserved;   // Bytes held in blocks and large allocations
+  size_t live;       // Bytes handed out, rounded to class size
+  size_t high_water; // Largest `live` since init
+  size_t copies;     // Reallocs that had to move their data
+} EcsPool;
+
+// Reserves `reserve` bytes (rounded up to whole pages) as the first block.
+void ecs_pool_init(EcsPool* pool, size_t page_size, size_t reserve);
+void ecs_pool_free(EcsPool* pool);
+
+void* ecs_pool_alloc(EcsPool* pool, size_t size);
+void* ecs_pool_realloc(EcsPool* pool, void* ptr, size_t size);
+void ecs_pool_release(EcsPool* pool, void* ptr);
@@ -16,12 +16,42 @@
 #include <stdlib.h>
 
 #include "../config/config.h"
+#include "../engine/arena.h"
+#include "../engine/asset.h"
 #include "../engine/game_state.h"
+#include "../engine/log.h"
+#include "../engine/memory.h"
 #include "../engine/platform.h"
+#include "../engine/profiler.h"
+#include "debug_overlay.h"
+#include "systems/systems.h"
 #include "world.h"
 
 GameState* state = nullptr;
 
+// Tick-handled key presses, latched per frame like the player's actions
+typedef enum GameKey {
+  GAME_KEY_DEBUG     = 1 << 0, // G
+  GAME_KEY_QUICKSAVE = 1 << 1, // F5
+  GAME_KEY_QUICKLOAD = 1 << 2, // F9
+  GAME_KEY_REWIND    = 1 << 3, // Backspace, only its press; rewind is held
+} GameKey;
+
+static uint8_t game_key_bit(CF_KeyButton key, GameKey bit) {
+  return cf_key_just_pressed(key) ? (uint8_t)bit : 0;
+}
+
+// CF polls input once per displayed frame, which runs any number of ticks.
+// Latching once per frame means a press reaches exactly one tick.
+static void latch_frame_input(void) {
+  latch_input_edges();
+
+  state->pending_keys |= game_key_bit(CF_KEY_G, GAME_KEY_DEBUG);
+  state->pending_keys |= game_key_bit(CF_KEY_F5, GAME_KEY_QUICKSAVE);
+  state->pending_keys |= game_key_bit(CF_KEY_F9, GAME_KEY_QUICKLOAD);
+  state->pending_keys |= game_key_bit(CF_KEY_BACKSPACE, GAME_KEY_REWIND);
+}
+
 static CF_V2 calculate_dest_size(CF_V2 game, CF_V2 window) {
   float game_aspect   = game.x / game.y;
   float window_aspect = window.x / window.y;
@@ -42,14 +72,20 @@ static CF_V2 calculate_dest_size(CF_V2 game, CF_V2 window) {
 }
 
 void game_init(Platform* platform) {
-  state = calloc(1, sizeof(GameState));
+  log_set_forward(platform->log_submit);
+  memory_set_forward(platform->memory_tag);
+
+  MEMORY_SCOPE(MEMORY_TAG_WORLD, state = cf_calloc(1, sizeof(GameState)));
   CF_ASSERT(state != nullptr);
 
-  state->platform       = platform;
-  state->scratch_arena  = malloc(sizeof(CF_Arena));
-  *state->scratch_arena = cf_make_arena(_Alignof(void*), CF_MB * 4);
+  state->version  = GAME_STATE_VERSION;
+  state->size     = sizeof(GameState);
+  state->platform = platform;
+  arena_init(&state->scratch_arena, "scratch", SCRATCH_ARENA_SIZE);
+  frame_arena_init(&state->frame_arena, "frame", FRAME_ARENA_SIZE);
   state->canvas =
       cf_make_canvas(cf_canvas_defaults(CANVAS_WIDTH, CANVAS_HEIGHT));
+  asset_cache_init(&state->assets, platform);
 
   // Set up projection for the game vcanvas
   cf_draw_projection(cf_ortho_2d(0, 0, CANVAS_WIDTH * CANVAS_SCALE,
@@ -57,22 +93,117 @@ void game_init(Platform* platform) {
 
   init_world();
 
+  // Playback wins if both are given
+  if (platform->replay_input_path) {
+    input_replay_start_playback(&state->world.replay,
+                                platform->replay_input_path);
+  } else if (platform->record_input_path) {
+    input_replay_start_recording(&state->world.replay,
+                                 platform->record_input_path);
+  }
+
+  // Behaviour waits for the player's sprite, so streamed loads would make
+  // the tick it starts on depend on I/O. Set before anything is acquired.
+  state->assets.synchronous = state->world.replay.mode != INPUT_REPLAY_OFF;
+
+  make_player();
+
+  // Bottom-left of the level at the bottom-left of the canvas
+  MEMORY_SCOPE(MEMORY_TAG_WORLD,
+               tilemap_load(&state->world.tilemap, "assets/levels/level_01.txt",
+                            cf_v2(-CANVAS_WIDTH / 2, -CANVAS_HEIGHT / 2)));
+
   cf_app_init_imgui();
 }
 
+// Advances, loads or rewinds the world by one tick. `keys` are the GameKey
+// presses latched since the last tick.
+static void step_world(World* world, uint8_t keys) {
+  // The snapshot keys aren't part of the recorded input bits, and a quickload
+  // or rewind takes the place of update_world and its input_replay_tick. So
+  // they are off while recording or playing back, or the stream and the
+  // session would no longer match.
+  if (world->replay.mode != INPUT_REPLAY_OFF) {
+    if (keys & (GAME_KEY_QUICKSAVE | GAME_KEY_QUICKLOAD | GAME_KEY_REWIND)) {
+      log_warn("snapshot", "Snapshots are off during input record/replay");
+    }
+
+    PROFILE_ZONE("update_world", update_world(CF_DELTA_TIME));
+    return;
+  }
+
+  if (keys & GAME_KEY_QUICKSAVE) {
+    PROFILE_ZONE("snapshot_capture", snapshot_capture(&world->quicksave));
+    log_info("snapshot", "Quicksaved (%zu bytes)", world->quicksave.size);
+  }
+
+  // Loaded and rewound states take this tick's place
+  if ((keys & GAME_KEY_QUICKLOAD) && world->quicksave.size > 0) {
+    bool restored = false;
+    PROFILE_ZONE("snapshot_restore",
+                 restored = snapshot_restore(&world->quicksave));
+    if (restored) {
+      log_info("snapshot", "Quickloaded");
+      return;
+    }
+  }
+
+  if (cf_key_down(CF_KEY_BACKSPACE)) {
+    PROFILE_ZONE("snapshot_history_rewind",
+                 snapshot_history_rewind(&world->history));
+    return;
+  }
+
+  PROFILE_ZONE("update_world", update_world(CF_DELTA_TIME));
+  PROFILE_ZONE("snapshot_history_push",
+               snapshot_history_push(&world->history));
+}
+
 bool game_update(void) {
-  cf_arena_reset(state->scratch_arena);
+  arena_reset(&state->scratch_arena);
+
+  // The last tick may still be recording; nothing changes the world before it
+  // is done
+  finish_record_world();
+
+  // A replay run ends with its recording
+  if (input_replay_finished(&state->world.replay)) {
+    log_info("replay", "Playback finished after %u ticks",
+             state->world.replay.tick);
+    return false;
+  }
+
+  uint8_t keys        = state->pending_keys;
+  state->pending_keys = 0;
 
-  if (cf_key_just_pressed(CF_KEY_G)) {
+  if (keys & GAME_KEY_DEBUG) {
     state->debug_mode = !state->debug_mode;
   }
 
-  update_world(CF_DELTA_TIME);
+  // Finish background sprite loads before systems pick them up
+  PROFILE_ZONE("asset_cache_update",
+               asset_cache_update(&state->assets, ASSET_FINISH_BUDGET_MS));
+
+  step_world(&state->world, keys);
 
+  // Overlaps with the rest of the frame; render_world replays it
+  record_world();
   return true;
 }
 
 void game_render(void) {
+  ProfileZone zone = profiler_begin("game_render");
+
+  // After this frame's ticks; the next one takes the presses
+  latch_frame_input();
+
+  // Fraction of a tick since the last game_update (fixed timestep)
+  state->world.alpha = CF_DELTA_TIME_INTERPOLANT;
+
+  // Rendering to a chunk canvas flushes queued draws, so bake before any
+  PROFILE_ZONE("tilemap_bake",
+               tilemap_bake(&state->world.tilemap, state->world.camera));
+
   cf_draw_push_filter(CF_DRAW_FILTER_NEAREST);
 
   // Render to the game canvas
@@ -105,17 +236,63 @@ void game_render(void) {
   }
 
   cf_draw_pop_filter();
+
+  if (state->debug_mode) {
+    debug_overlay_draw();
+  }
+
+  profiler_end(zone);
+  profiler_frame();
+
+  frame_arena_swap(&state->frame_arena);
 }
 
 void game_shutdown(void) {
-  shutdown_world();
-  free(state->scratch_arena);
-  free(state);
+  input_replay_stop(&state->world.replay); // Writes a recording out
+  shutdown_world(); // Releases the sprites held by components
+  asset_cache_free(&state->assets);
+  arena_free(&state->scratch_arena);
+  frame_arena_free(&state->frame_arena);
+  cf_free(state);
 }
 
 void* game_state(void) { return state; }
 
+// Compared by the host before a reload: a library with another layout can't
+// take over the running state
+uint64_t game_state_layout(void) {
+  return ((uint64_t)GAME_STATE_VERSION << 32) | sizeof(GameState);
+}
+
+// The host unloads this library next. Jobs running its code are joined here,
+// so their results are taken in as well (platform_jobs_wait_idle in the host
+// only drains the workers).
+void game_prepare_reload(void) {
+  finish_record_world();
+  asset_cache_wait(&state->assets);
+}
+
 void game_hot_reload(void* game_state) {
   state = (GameState*)game_state;
+  log_set_forward(state->platform->log_submit);
+  memory_set_forward(state->platform->memory_tag);
+
+  // The host checked game_state_layout already. Carrying on would read every
+  // field after the change at the wrong offset.
+  if (state->version != GAME_STATE_VERSION ||
+      state->size != sizeof(GameState)) {
+    log_fatal("game",
+              "GameState layout changed (v%u, %u bytes -> v%d, %zu bytes), "
+              "restart the game",
+              state->version, state->size, GAME_STATE_VERSION,
+              sizeof(GameState));
+    abort();
+  }
+
+  // Arena names are string literals of the previous library
+  state->scratch_arena.name          = "scratch";
+  state->frame_arena.buffers[0].name = "frame";
+  state->frame_arena.buffers[1].name = "frame";
+
   world_hot_reload();
 }
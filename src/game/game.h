@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef ENGINE_PLATFORM_WINDOWS
 #define EXPORT __declspec(dllexport)
@@ -15,4 +16,6 @@ EXPORT bool game_update(void);
 EXPORT void game_render(void);
 EXPORT void game_shutdown(void);
 EXPORT void* game_state(void);
+EXPORT uint64_t game_state_layout(void);
+EXPORT void game_prepare_reload(void);
 EXPORT void game_hot_reload(void* game_state);
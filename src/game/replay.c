@@ -0,0 +1,216 @@
+// replay.c - Deterministic input recording and playback
+//
+// Recordings are built in memory and written in one go when stopped, so a
+// session never touches the disk mid-game. Files are read and written with
+// SDL since the paths come from the command line, outside the CF mounts.
+
+#include "replay.h"
+
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
+#include <cute_alloc.h>
+#include <cute_array.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../config/config.h"
+#include "../engine/log.h"
+
+typedef struct InputReplayHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t tick_rate;
+  uint32_t tick_count;
+} InputReplayHeader;
+
+#define INPUT_REPLAY_MAX_RUN UINT8_MAX
+#define INPUT_REPLAY_HEADER_SIZE (4 * sizeof(uint32_t))
+
+// =============================================================================
+// Header
+// =============================================================================
+
+// Header fields are little-endian on disk whatever the host byte order
+static void put_u32_le(uint8_t* out, uint32_t value) {
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+  out[2] = (uint8_t)(value >> 16);
+  out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get_u32_le(const uint8_t* in) {
+  return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 |
+         (uint32_t)in[3] << 24;
+}
+
+static void encode_header(uint8_t* out, const InputReplayHeader* header) {
+  put_u32_le(out + 0, header->magic);
+  put_u32_le(out + 4, header->version);
+  put_u32_le(out + 8, header->tick_rate);
+  put_u32_le(out + 12, header->tick_count);
+}
+
+static InputReplayHeader decode_header(const uint8_t* in) {
+  return (InputReplayHeader){
+      .magic      = get_u32_le(in + 0),
+      .version    = get_u32_le(in + 4),
+      .tick_rate  = get_u32_le(in + 8),
+      .tick_count = get_u32_le(in + 12),
+  };
+}
+
+// =============================================================================
+// Recording
+// =============================================================================
+
+bool input_replay_start_recording(InputReplay* replay, const char* path) {
+  *replay = (InputReplay){.mode = INPUT_REPLAY_RECORDING, .path = path};
+
+  InputReplayHeader header = {
+      .magic     = INPUT_REPLAY_MAGIC,
+      .version   = INPUT_REPLAY_VERSION,
+      .tick_rate = SIM_TICK_RATE,
+  };
+  uint8_t bytes[INPUT_REPLAY_HEADER_SIZE];
+  encode_header(bytes, &header);
+  for (size_t i = 0; i < sizeof(bytes); i++) {
+    cf_array_push(replay->data, bytes[i]);
+  }
+
+  log_info("replay", "Recording input to %s", path);
+  return true;
+}
+
+static void input_replay_end_run(InputReplay* replay) {
+  if (replay->run > 0) {
+    cf_array_push(replay->data, replay->bits);
+    cf_array_push(replay->data, (uint8_t)replay->run);
+    replay->run = 0;
+  }
+}
+
+static void input_replay_record(InputReplay* replay, uint8_t bits) {
+  if (bits != replay->bits || replay->run == INPUT_REPLAY_MAX_RUN) {
+    input_replay_end_run(replay);
+    replay->bits = bits;
+  }
+
+  replay->run++;
+  replay->tick++;
+}
+
+// =============================================================================
+// Playback
+// =============================================================================
+
+bool input_replay_start_playback(InputReplay* replay, const char* path) {
+  *replay = (InputReplay){0};
+
+  size_t size   = 0;
+  uint8_t* data = SDL_LoadFile(path, &size);
+  if (!data) {
+    log_error("replay", "Failed to read %s", path);
+    return false;
+  }
+
+  InputReplayHeader header = {0};
+  if (size >= INPUT_REPLAY_HEADER_SIZE) {
+    header = decode_header(data);
+  }
+
+  if (header.magic != INPUT_REPLAY_MAGIC ||
+      header.version != INPUT_REPLAY_VERSION) {
+    log_error("replay", "%s is not an input recording", path);
+    SDL_free(data);
+    return false;
+  }
+
+  // A different tick rate would replay the same inputs over different dt
+  if (header.tick_rate != SIM_TICK_RATE) {
+    log_error("replay", "%s was recorded at %u ticks/s, this build runs %d",
+              path, header.tick_rate, SIM_TICK_RATE);
+    SDL_free(data);
+    return false;
+  }
+
+  *replay = (InputReplay){
+      .mode       = INPUT_REPLAY_PLAYING,
+      .data       = data,
+      .size       = size,
+      .cursor     = INPUT_REPLAY_HEADER_SIZE,
+      .tick_count = header.tick_count,
+  };
+
+  log_info("replay", "Playing %u ticks from %s", header.tick_count, path);
+  return true;
+}
+
+static uint8_t input_replay_play(InputReplay* replay) {
+  if (replay->tick >= replay->tick_count) {
+    return 0;
+  }
+
+  if (replay->run == 0) {
+    // The recorder never writes an empty run, so one means a corrupt file
+    bool truncated = replay->cursor + 2 > replay->size;
+    if (truncated || replay->data[replay->cursor + 1] == 0) {
+      log_error("replay", "Recording %s at tick %u, stopping playback",
+                truncated ? "truncated" : "corrupt", replay->tick);
+      replay->tick_count = replay->tick;
+      return 0;
+    }
+
+    replay->bits = replay->data[replay->cursor];
+    replay->run  = replay->data[replay->cursor + 1];
+    replay->cursor += 2;
+  }
+
+  replay->run--;
+  replay->tick++;
+  return replay->bits;
+}
+
+// =============================================================================
+// Ticks
+// =============================================================================
+
+uint8_t input_replay_tick(InputReplay* replay, uint8_t bits) {
+  switch (replay->mode) {
+  case INPUT_REPLAY_RECORDING:
+    input_replay_record(replay, bits);
+    return bits;
+  case INPUT_REPLAY_PLAYING:
+    return input_replay_play(replay);
+  default:
+    return bits;
+  }
+}
+
+bool input_replay_finished(const InputReplay* replay) {
+  return replay->mode == INPUT_REPLAY_PLAYING &&
+         replay->tick >= replay->tick_count;
+}
+
+void input_replay_stop(InputReplay* replay) {
+  if (replay->mode == INPUT_REPLAY_RECORDING) {
+    input_replay_end_run(replay);
+
+    // Tick count is only known now
+    put_u32_le(replay->data + offsetof(InputReplayHeader, tick_count),
+               replay->tick);
+
+    size_t size = (size_t)cf_array_count(replay->data);
+    if (SDL_SaveFile(replay->path, replay->data, size)) {
+      log_info("replay", "Wrote %u ticks (%zu bytes) to %s", replay->tick,
+               size, replay->path);
+    } else {
+      log_error("replay", "Failed to write %s", replay->path);
+    }
+
+    cf_array_free(replay->data);
+  } else if (replay->mode == INPUT_REPLAY_PLAYING) {
+    SDL_free(replay->data);
+  }
+
+  *replay = (InputReplay){0};
+}
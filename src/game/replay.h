@@ -0,0 +1,56 @@
+// replay.h - Deterministic input recording and playback
+//
+// Records the player input sampled each simulation tick and feeds it back
+// through the same path on playback. The simulation has a fixed step, and
+// while recording or playing back, sprites load synchronously
+// (AssetCache.synchronous) so streaming can't shift when behaviour starts.
+// Inputs are stored as one bit per C_PlayerInput field, run-length encoded:
+//
+//   header  magic "TTIR", version, tick rate, tick count (uint32 LE each)
+//   runs    { uint8 bits, uint8 length } until tick count is reached
+//
+// Start with --record <path> or --replay <path>; bench_world also accepts
+// --replay for headless captures of a recorded session.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define INPUT_REPLAY_MAGIC 0x52495454 // "TTIR"
+#define INPUT_REPLAY_VERSION 1
+
+typedef enum InputReplayMode {
+  INPUT_REPLAY_OFF,
+  INPUT_REPLAY_RECORDING,
+  INPUT_REPLAY_PLAYING,
+} InputReplayMode;
+
+typedef struct InputReplay {
+  InputReplayMode mode;
+  const char* path; // Recording: written by input_replay_stop
+
+  uint8_t* data; // Recording: cf_array of the stream. Playing: the file.
+  size_t size;   // Playing: bytes in `data`
+  size_t cursor; // Playing: offset of the next run
+
+  uint8_t bits;        // Input of the current run
+  uint32_t run;        // Recording: ticks in the run. Playing: ticks left.
+  uint32_t tick;       // Ticks recorded or played so far
+  uint32_t tick_count; // Playing: ticks in the stream
+} InputReplay;
+
+// Both return false (leaving the replay off) if the file cannot be used.
+bool input_replay_start_recording(InputReplay* replay, const char* path);
+bool input_replay_start_playback(InputReplay* replay, const char* path);
+
+// Called once per tick with the live input bits. Recording appends and
+// returns them; playback returns the recorded bits (zero past the end).
+uint8_t input_replay_tick(InputReplay* replay, uint8_t bits);
+
+// True once playback has fed every recorded tick.
+bool input_replay_finished(const InputReplay* replay);
+
+// Writes out a recording, then frees the stream in either mode.
+void input_replay_stop(InputReplay* replay);
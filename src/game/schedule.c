@@ -0,0 +1,145 @@
+// schedule.c - Parallel system scheduler
+//
+// Builds dependency stages from declared component access and runs them on the
+// platform job system.
+
+#include "schedule.h"
+
+#include "../engine/profiler.h"
+
+#include <cute_c_runtime.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// Dependency Graph
+// =============================================================================
+
+// Two systems conflict when one writes a component the other reads or writes.
+static bool systems_conflict(const SystemAccess* a, const SystemAccess* b) {
+  return (a->writes & (b->reads | b->writes)) || (b->writes & a->reads);
+}
+
+// Levels the graph: a system runs one stage after the latest earlier system
+// it conflicts with, so conflicting systems keep their declared order.
+static void schedule_build(Schedule* schedule) {
+  schedule->stage_count = 0;
+
+  for (size_t i = 0; i < schedule->count; i++) {
+    const SystemAccess* access = &schedule->access[schedule->order[i].id];
+    uint8_t stage              = 0;
+
+    for (size_t j = 0; j < i; j++) {
+      const SystemAccess* other = &schedule->access[schedule->order[j].id];
+      if (systems_conflict(access, other) && schedule->stage[j] >= stage) {
+        stage = (uint8_t)(schedule->stage[j] + 1);
+      }
+    }
+
+    schedule->stage[i] = stage;
+    if ((size_t)stage + 1 > schedule->stage_count) {
+      schedule->stage_count = (size_t)stage + 1;
+    }
+  }
+}
+
+// =============================================================================
+// Lifecycle and Declarations
+// =============================================================================
+
+void schedule_init(Schedule* schedule, Platform* platform) {
+  *schedule          = (Schedule){0};
+  schedule->platform = platform;
+}
+
+void schedule_free(Schedule* schedule) { *schedule = (Schedule){0}; }
+
+void schedule_read(Schedule* schedule, ecs_system_t system, ecs_comp_t comp) {
+  CF_ASSERT(system.id < SCHEDULE_MAX_SYSTEMS && comp.id < 64);
+  schedule->access[system.id].reads |= (uint64_t)1 << comp.id;
+}
+
+void schedule_write(Schedule* schedule, ecs_system_t system, ecs_comp_t comp) {
+  CF_ASSERT(system.id < SCHEDULE_MAX_SYSTEMS && comp.id < 64);
+  schedule->access[system.id].writes |= (uint64_t)1 << comp.id;
+}
+
+void schedule_main_thread(Schedule* schedule, ecs_system_t system) {
+  CF_ASSERT(system.id < SCHEDULE_MAX_SYSTEMS);
+  schedule->access[system.id].main_thread = true;
+}
+
+void schedule_parallel(Schedule* schedule, ecs_system_t system,
+                       size_t min_batch) {
+  CF_ASSERT(system.id < SCHEDULE_MAX_SYSTEMS && min_batch > 0);
+  schedule->access[system.id].min_batch = min_batch;
+}
+
+void schedule_add(Schedule* schedule, ecs_system_t system, const char* name) {
+  CF_ASSERT(schedule->count < SCHEDULE_MAX_SYSTEMS);
+  schedule->names[schedule->count]   = name;
+  schedule->order[schedule->count++] = system;
+  schedule_build(schedule);
+}
+
+// =============================================================================
+// Execution
+// =============================================================================
+
+static void schedule_run_range(void* udata, size_t begin, size_t end) {
+  ScheduleTask* task = (ScheduleTask*)udata;
+  PROFILE_ZONE(task->name, ecs_run_system_range(task->ecs, task->system, begin,
+                                                end - begin, task->mask));
+}
+
+// Same test as ecs_run_system, made before any job is queued
+static bool schedule_masked(ecs_t* ecs, ecs_system_t system, ecs_mask_t mask) {
+  ecs_mask_t system_mask = ecs_get_system_mask(ecs, system);
+  return system_mask != 0 && !(system_mask & mask);
+}
+
+void schedule_run(Schedule* schedule, ecs_t* ecs, ecs_mask_t mask) {
+  Platform* platform = schedule->platform;
+
+  for (size_t stage = 0; stage < schedule->stage_count; stage++) {
+    JobCounter counter = {0};
+
+    // Hand worker systems to the job system
+    for (size_t i = 0; i < schedule->count; i++) {
+      ecs_system_t system        = schedule->order[i];
+      const SystemAccess* access = &schedule->access[system.id];
+      size_t count               = ecs_get_system_entity_count(ecs, system);
+
+      if (schedule->stage[i] != stage || access->main_thread || count == 0 ||
+          schedule_masked(ecs, system, mask)) {
+        continue;
+      }
+
+      schedule->tasks[i] = (ScheduleTask){.ecs    = ecs,
+                                          .system = system,
+                                          .mask   = mask,
+                                          .name   = schedule->names[i]};
+      platform->job_parallel_for(count, access->min_batch, schedule_run_range,
+                                 &schedule->tasks[i], &counter);
+    }
+
+    // Main-thread systems overlap with the workers
+    for (size_t i = 0; i < schedule->count; i++) {
+      ecs_system_t system = schedule->order[i];
+      size_t count        = ecs_get_system_entity_count(ecs, system);
+
+      if (schedule->stage[i] != stage ||
+          !schedule->access[system.id].main_thread || count == 0 ||
+          schedule_masked(ecs, system, mask)) {
+        continue;
+      }
+
+      PROFILE_ZONE(schedule->names[i],
+                   ecs_run_system_range(ecs, system, 0, count, mask));
+    }
+
+    // The main thread joins in on whatever is still queued
+    platform->job_wait(&counter);
+    ecs_flush(ecs);
+  }
+}
@@ -0,0 +1,68 @@
+// schedule.h - Parallel system scheduler
+//
+// Systems declare which components they read and write (ECS_READ_COMP /
+// ECS_WRITE_COMP in world.h). The schedule turns the update order into a
+// dependency graph: a system depends on every earlier system it conflicts
+// with, and systems are grouped into stages by dependency depth. Systems in
+// the same stage run concurrently on a worker pool; large systems have their
+// entity range split into batches. Work runs on the host's job system
+// (Platform), so workers persist across game library reloads.
+//
+// Systems that run off the main thread must not create/destroy entities or
+// add/remove components. Queued destroys/removes are flushed after each stage.
+
+#pragma once
+
+#include <pico_ecs.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../engine/platform.h"
+
+#define SCHEDULE_MAX_SYSTEMS 32
+
+// Component access and threading constraints of one system
+typedef struct SystemAccess {
+  uint64_t reads;   // Component bits read
+  uint64_t writes;  // Component bits written
+  bool main_thread; // Must run on the calling thread (input, sprites)
+  size_t min_batch; // Split entity range in batches of at least this size
+} SystemAccess;
+
+// Job payload for one scheduled system (ranges come from job_parallel_for)
+typedef struct ScheduleTask {
+  ecs_t* ecs;
+  ecs_system_t system;
+  ecs_mask_t mask;
+  const char* name;
+} ScheduleTask;
+
+typedef struct Schedule {
+  SystemAccess access[SCHEDULE_MAX_SYSTEMS]; // Indexed by system ID
+  ecs_system_t order[SCHEDULE_MAX_SYSTEMS];  // Systems in update order
+  const char* names[SCHEDULE_MAX_SYSTEMS];   // Profiler zone of order[i]
+  uint8_t stage[SCHEDULE_MAX_SYSTEMS];       // Stage of order[i]
+  size_t count;
+  size_t stage_count;
+
+  Platform* platform;
+  ScheduleTask tasks[SCHEDULE_MAX_SYSTEMS]; // Indexed like order
+} Schedule;
+
+void schedule_init(Schedule* schedule, Platform* platform);
+void schedule_free(Schedule* schedule);
+
+// Access declarations (called from the ECS_*_COMP macros)
+void schedule_read(Schedule* schedule, ecs_system_t system, ecs_comp_t comp);
+void schedule_write(Schedule* schedule, ecs_system_t system, ecs_comp_t comp);
+void schedule_main_thread(Schedule* schedule, ecs_system_t system);
+void schedule_parallel(Schedule* schedule, ecs_system_t system,
+                       size_t min_batch);
+
+// Appends a system to the update order and rebuilds the stages. `name` is
+// the static string its profiler zones are recorded under.
+void schedule_add(Schedule* schedule, ecs_system_t system, const char* name);
+
+// Runs the scheduled systems whose mask overlaps `mask` (systems with mask 0
+// always run), stage by stage. Skipped systems hand out no jobs.
+void schedule_run(Schedule* schedule, ecs_t* ecs, ecs_mask_t mask);
@@ -0,0 +1,527 @@
+// snapshot.c - World snapshots for quicksave, quickload and rewind
+//
+// Captures write every section straight into the reused buffer; restores
+// check the whole header before touching the world, so a refused snapshot
+// leaves it as it was.
+
+#include "snapshot.h"
+
+#include <cute_alloc.h>
+#include <cute_array.h>
+#include <cute_c_runtime.h>
+#include <cute_sprite.h>
+#include <string.h>
+
+#include "../engine/arena.h"
+#include "../engine/game_state.h"
+#include "../engine/log.h"
+#include "../engine/memory.h"
+#include "world.h"
+
+typedef struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t layout_hash; // Component layouts of the capturing library
+  uint32_t asset_count;
+  uint64_t ecs_size;
+  uint64_t body_count;
+  uint64_t assets_size;
+  int32_t tiles_width;
+  int32_t tiles_height;
+  ecs_entity_t player;
+} SnapshotHeader;
+
+// Per asset in the assets section, followed by the NUL-terminated path
+typedef struct SnapshotAsset {
+  uint32_t id;
+  uint32_t length; // Including the NUL
+} SnapshotAsset;
+
+// A delta starts with the sizes of both sides, then runs of
+// { uint32 unchanged bytes, uint32 changed bytes, XOR of the changed bytes }
+typedef struct SnapshotDeltaHeader {
+  uint64_t sizes[2];
+} SnapshotDeltaHeader;
+
+// Unchanged bytes shorter than this stay inside a changed run, since a new
+// run header would cost as much
+#define SNAPSHOT_DELTA_MIN_GAP 8
+
+#define SNAPSHOT_BODY_SIZE (4 * sizeof(float) + sizeof(ecs_entity_t))
+
+// =============================================================================
+// Buffers
+// =============================================================================
+
+static void snapshot_reserve(Snapshot* snapshot, size_t capacity) {
+  if (capacity <= snapshot->capacity) {
+    return;
+  }
+
+  size_t grown = snapshot->capacity ? snapshot->capacity * 2 : 4096;
+  while (grown < capacity) {
+    grown *= 2;
+  }
+
+  MEMORY_SCOPE(MEMORY_TAG_WORLD,
+               snapshot->data = cf_realloc(snapshot->data, grown));
+  CF_ASSERT(snapshot->data);
+  snapshot->capacity = grown;
+}
+
+static void snapshot_append(Snapshot* snapshot, const void* data, size_t size) {
+  snapshot_reserve(snapshot, snapshot->size + size);
+  memcpy(snapshot->data + snapshot->size, data, size);
+  snapshot->size += size;
+}
+
+void snapshot_free(Snapshot* snapshot) {
+  cf_free(snapshot->data);
+  *snapshot = (Snapshot){0};
+}
+
+// FNV-1a over every registered component layout
+static uint32_t layout_hash(const World* world) {
+  uint32_t hash = 2166136261u;
+
+  for (size_t i = 0; i < world->layout_count; i++) {
+    const ComponentLayout* layout = &world->layouts[i];
+
+    uint64_t fields[] = {layout->size, layout->align, layout->storage,
+                         layout->version};
+
+    const uint8_t* bytes[] = {(const uint8_t*)layout->name,
+                              (const uint8_t*)fields};
+    size_t sizes[]         = {strlen(layout->name), sizeof(fields)};
+
+    for (size_t b = 0; b < 2; b++) {
+      for (size_t j = 0; j < sizes[b]; j++) {
+        hash = (hash ^ bytes[b][j]) * 16777619u;
+      }
+    }
+  }
+
+  return hash;
+}
+
+// =============================================================================
+// Capture
+// =============================================================================
+
+void snapshot_capture(Snapshot* snapshot) {
+  World* world   = &state->world;
+  Arena* arena   = &state->scratch_arena;
+  ArenaTemp temp = arena_temp_begin(arena);
+
+  // Distinct sprite assets, in row order
+  ecs_view_t sprites   = ECS_VIEW(C_Sprite);
+  const C_Sprite* rows = sprites.data;
+  uint32_t* assets     = ARENA_PUSH_ARRAY(arena, uint32_t, sprites.count);
+  uint32_t asset_count = 0;
+  size_t assets_size   = 0;
+
+  for (size_t row = 0; row < sprites.count; row++) {
+    uint32_t id      = rows[row].asset.id;
+    const char* path = asset_path(&state->assets, rows[row].asset);
+    if (!path) {
+      continue;
+    }
+
+    uint32_t i = 0;
+    while (i < asset_count && assets[i] != id) {
+      i++;
+    }
+    if (i == asset_count) {
+      assets[asset_count++] = id;
+      assets_size += sizeof(SnapshotAsset) + strlen(path) + 1;
+    }
+  }
+
+  const Bodies* bodies   = &world->bodies;
+  const Tilemap* tilemap = &world->tilemap;
+  size_t tile_count      = (size_t)tilemap->width * (size_t)tilemap->height;
+
+  SnapshotHeader header = {
+      .magic        = SNAPSHOT_MAGIC,
+      .version      = SNAPSHOT_VERSION,
+      .layout_hash  = layout_hash(world),
+      .asset_count  = asset_count,
+      .ecs_size     = ecs_save(world->ecs, nullptr, 0),
+      .body_count   = bodies->count,
+      .assets_size  = assets_size,
+      .tiles_width  = tilemap->width,
+      .tiles_height = tilemap->height,
+      .player       = world->player,
+  };
+
+  snapshot->size = 0;
+  snapshot_reserve(snapshot, sizeof(header) + header.ecs_size +
+                                 bodies->count * SNAPSHOT_BODY_SIZE +
+                                 assets_size + tile_count);
+
+  snapshot_append(snapshot, &header, sizeof(header));
+
+  ecs_save(world->ecs, snapshot->data + snapshot->size, header.ecs_size);
+  snapshot->size += header.ecs_size;
+
+  snapshot_append(snapshot, bodies->x, bodies->count * sizeof(float));
+  snapshot_append(snapshot, bodies->y, bodies->count * sizeof(float));
+  snapshot_append(snapshot, bodies->vx, bodies->count * sizeof(float));
+  snapshot_append(snapshot, bodies->vy, bodies->count * sizeof(float));
+  snapshot_append(snapshot, bodies->entities,
+                  bodies->count * sizeof(ecs_entity_t));
+
+  for (uint32_t i = 0; i < asset_count; i++) {
+    const char* path    = asset_path(&state->assets, (AssetHandle){assets[i]});
+    SnapshotAsset asset = {assets[i], (uint32_t)strlen(path) + 1};
+    snapshot_append(snapshot, &asset, sizeof(asset));
+    snapshot_append(snapshot, path, asset.length);
+  }
+
+  snapshot_append(snapshot, tilemap->tiles, tile_count);
+
+  arena_temp_end(temp);
+}
+
+// =============================================================================
+// Restore
+// =============================================================================
+
+static bool snapshot_check(const Snapshot* snapshot, SnapshotHeader* header) {
+  if (snapshot->size < sizeof(*header)) {
+    log_error("snapshot", "Empty snapshot");
+    return false;
+  }
+  memcpy(header, snapshot->data, sizeof(*header));
+
+  if (header->magic != SNAPSHOT_MAGIC || header->version != SNAPSHOT_VERSION) {
+    log_error("snapshot", "Not a v%d snapshot", SNAPSHOT_VERSION);
+    return false;
+  }
+
+  if (header->layout_hash != layout_hash(&state->world)) {
+    log_error("snapshot", "Component layouts changed since the capture");
+    return false;
+  }
+
+  const Tilemap* tilemap = &state->world.tilemap;
+  if (header->tiles_width != tilemap->width ||
+      header->tiles_height != tilemap->height) {
+    log_error("snapshot", "Captured on another level (%dx%d tiles)",
+              header->tiles_width, header->tiles_height);
+    return false;
+  }
+
+  size_t tile_count = (size_t)tilemap->width * (size_t)tilemap->height;
+  size_t size       = sizeof(*header) + header->ecs_size +
+                header->body_count * SNAPSHOT_BODY_SIZE +
+                header->assets_size + tile_count;
+  if (size != snapshot->size) {
+    log_error("snapshot", "Truncated snapshot (%zu of %zu bytes)",
+              snapshot->size, size);
+    return false;
+  }
+
+  return true;
+}
+
+// Path a handle of the captured state was acquired with
+static const char* saved_path(const uint8_t* assets, uint32_t count,
+                              uint32_t id) {
+  for (uint32_t i = 0; i < count; i++) {
+    SnapshotAsset asset;
+    memcpy(&asset, assets, sizeof(asset));
+    if (asset.id == id) {
+      return (const char*)assets + sizeof(asset);
+    }
+    assets += sizeof(asset) + asset.length;
+  }
+  return nullptr;
+}
+
+// Rebuilds a restored sprite on a reference of its own. The saved CF_Sprite
+// holds pointers into the cache entry of the captured state, so only its
+// playback fields are kept on top of a fresh template.
+static void restore_sprite(ecs_entity_t entity, C_Sprite* sprite,
+                           const char* path) {
+  CF_Sprite saved      = sprite->sprite;
+  sprite->asset        = asset_acquire_sprite(&state->assets, path);
+  sprite->sprite       = asset_sprite(&state->assets, sprite->asset);
+  sprite->sprite.scale = saved.scale; // Facing flip
+
+  bool loading =
+      ecs_has(state->world.ecs, entity, ECS_GET_COMP(C_SpriteLoading));
+
+  // Unloaded since the capture: back on the placeholder
+  if (!asset_is_ready(&state->assets, sprite->asset)) {
+    sprite->clip = ANIM_CLIP_NONE;
+    if (!loading) {
+      ECS_ADD(entity, C_SpriteLoading);
+    }
+    return;
+  }
+
+  // sys_resolve_sprites swaps in the template next tick
+  if (loading) {
+    return;
+  }
+
+  const AnimClipSet* set =
+      animations_resolve(&state->world.animations, &state->assets,
+                         sprite->asset, &sprite->sprite);
+  const CF_Animation* animation =
+      sprite->clip ? set->clips[sprite->clip] : sprite->sprite.animation;
+
+  // Clip no longer in the sprite file: start over on the default animation
+  if (!animation) {
+    sprite->clip = ANIM_CLIP_NONE;
+    return;
+  }
+
+  CF_Sprite* s             = &sprite->sprite;
+  s->animation             = animation;
+  s->frame_index           = saved.frame_index;
+  s->loop_count            = saved.loop_count;
+  s->play_speed_multiplier = saved.play_speed_multiplier;
+  s->paused                = saved.paused;
+  s->loop                  = saved.loop;
+  s->t                     = saved.t;
+  s->opacity               = saved.opacity;
+  s->transform             = saved.transform;
+
+  if (s->frame_index >= cf_array_count(animation->frames)) {
+    s->frame_index = 0;
+    s->t           = 0.0f;
+  }
+}
+
+bool snapshot_restore(const Snapshot* snapshot) {
+  SnapshotHeader header;
+  if (!snapshot_check(snapshot, &header)) {
+    return false;
+  }
+
+  World* world   = &state->world;
+  Arena* arena   = &state->scratch_arena;
+  ArenaTemp temp = arena_temp_begin(arena);
+
+  const uint8_t* cursor = snapshot->data + sizeof(header);
+  const uint8_t* ecs    = cursor;
+  const uint8_t* bodies = ecs + header.ecs_size;
+  const uint8_t* assets = bodies + header.body_count * SNAPSHOT_BODY_SIZE;
+  const uint8_t* tiles  = assets + header.assets_size;
+
+  // References of the current sprites are dropped after the restored ones
+  // are taken, so assets used by both stay loaded
+  ecs_view_t sprites    = ECS_VIEW(C_Sprite);
+  size_t released_count = sprites.count;
+  AssetHandle* released =
+      ARENA_PUSH_ARRAY(arena, AssetHandle, released_count);
+  for (size_t row = 0; row < released_count; row++) {
+    released[row] = ((const C_Sprite*)sprites.data)[row].asset;
+  }
+
+  if (!ecs_load(world->ecs, ecs, header.ecs_size)) {
+    log_error("snapshot", "ECS state doesn't match the defined components");
+    arena_temp_end(temp);
+    return false;
+  }
+
+  size_t count = header.body_count;
+  bodies_resize(&world->bodies, count);
+  memcpy(world->bodies.x, bodies, count * sizeof(float));
+  memcpy(world->bodies.y, bodies + count * sizeof(float),
+         count * sizeof(float));
+  memcpy(world->bodies.vx, bodies + count * 2 * sizeof(float),
+         count * sizeof(float));
+  memcpy(world->bodies.vy, bodies + count * 3 * sizeof(float),
+         count * sizeof(float));
+  memcpy(world->bodies.entities, bodies + count * 4 * sizeof(float),
+         count * sizeof(ecs_entity_t));
+
+  world->player = header.player;
+
+  // Through tilemap_set, so changed chunks are baked again
+  Tilemap* tilemap = &world->tilemap;
+  for (int y = 0; y < tilemap->height; y++) {
+    for (int x = 0; x < tilemap->width; x++) {
+      tilemap_set(tilemap, x, y, (TileKind)tiles[y * tilemap->width + x]);
+    }
+  }
+
+  sprites = ECS_VIEW(C_Sprite);
+  for (size_t row = 0; row < sprites.count; row++) {
+    C_Sprite* sprite    = (C_Sprite*)sprites.data + row;
+    ecs_entity_t entity = {sprites.owners[row]};
+    restore_sprite(entity, sprite,
+                   saved_path(assets, header.asset_count, sprite->asset.id));
+  }
+
+  for (size_t i = 0; i < released_count; i++) {
+    asset_release_sprite(&state->assets, released[i]);
+  }
+
+  // Derived from the restored state; contacts and events of the replaced one
+  // name entities that may not exist any more
+  collisions_clear(&world->collisions);
+  world->animations.finished = (AnimEvents){0};
+  ECS_RUN_SYSTEM(sys_index_spatial);
+
+  arena_temp_end(temp);
+  return true;
+}
+
+// =============================================================================
+// Deltas
+// =============================================================================
+
+static inline uint8_t snapshot_byte(const Snapshot* snapshot, size_t i) {
+  return i < snapshot->size ? snapshot->data[i] : 0;
+}
+
+static void delta_append_u32(Snapshot* delta, size_t value) {
+  uint32_t v = (uint32_t)value;
+  snapshot_append(delta, &v, sizeof(v));
+}
+
+void snapshot_delta_encode(const Snapshot* a, const Snapshot* b,
+                           Snapshot* delta) {
+  size_t common = a->size < b->size ? a->size : b->size;
+  size_t total  = a->size < b->size ? b->size : a->size;
+
+  SnapshotDeltaHeader header = {{a->size, b->size}};
+  delta->size                = 0;
+  snapshot_append(delta, &header, sizeof(header));
+
+  size_t i = 0;
+  while (i < total) {
+    size_t start = i;
+
+    // Unchanged bytes, a word at a time where both sides have them
+    while (i + sizeof(uint64_t) <= common &&
+           memcmp(a->data + i, b->data + i, sizeof(uint64_t)) == 0) {
+      i += sizeof(uint64_t);
+    }
+    while (i < total && snapshot_byte(a, i) == snapshot_byte(b, i)) {
+      i++;
+    }
+    if (i == total) {
+      break;
+    }
+
+    size_t changed = i;
+    size_t same    = 0;
+    while (i < total && same < SNAPSHOT_DELTA_MIN_GAP) {
+      same = snapshot_byte(a, i) == snapshot_byte(b, i) ? same + 1 : 0;
+      i++;
+    }
+    i -= same;
+
+    delta_append_u32(delta, changed - start);
+    delta_append_u32(delta, i - changed);
+    snapshot_reserve(delta, delta->size + (i - changed));
+    for (size_t j = changed; j < i; j++) {
+      delta->data[delta->size++] = snapshot_byte(a, j) ^ snapshot_byte(b, j);
+    }
+  }
+}
+
+void snapshot_delta_apply(Snapshot* snapshot, const Snapshot* delta) {
+  SnapshotDeltaHeader header;
+  memcpy(&header, delta->data, sizeof(header));
+  CF_ASSERT(snapshot->size == header.sizes[0] ||
+            snapshot->size == header.sizes[1]);
+
+  size_t other = snapshot->size == header.sizes[0] ? header.sizes[1]
+                                                   : header.sizes[0];
+  size_t total = snapshot->size < other ? other : snapshot->size;
+
+  // The longer side's tail XORs against zeros
+  snapshot_reserve(snapshot, total);
+  memset(snapshot->data + snapshot->size, 0, total - snapshot->size);
+
+  const uint8_t* cursor = delta->data + sizeof(header);
+  const uint8_t* end    = delta->data + delta->size;
+  size_t i              = 0;
+
+  while (cursor < end) {
+    uint32_t run[2];
+    memcpy(run, cursor, sizeof(run));
+    cursor += sizeof(run);
+
+    i += run[0];
+    for (uint32_t j = 0; j < run[1]; j++) {
+      snapshot->data[i++] ^= *cursor++;
+    }
+  }
+
+  snapshot->size = other;
+}
+
+// =============================================================================
+// History
+// =============================================================================
+
+void snapshot_history_free(SnapshotHistory* history) {
+  snapshot_free(&history->latest);
+  snapshot_free(&history->capture);
+  for (size_t i = 0; i < SNAPSHOT_HISTORY_TICKS; i++) {
+    snapshot_free(&history->deltas[i]);
+  }
+  history->head        = 0;
+  history->count       = 0;
+  history->delta_bytes = 0;
+}
+
+void snapshot_history_clear(SnapshotHistory* history) {
+  history->latest.size = 0;
+  history->head        = 0;
+  history->count       = 0;
+  history->delta_bytes = 0;
+}
+
+void snapshot_history_push(SnapshotHistory* history) {
+  if (history->latest.size == 0) {
+    snapshot_capture(&history->latest);
+    return;
+  }
+
+  snapshot_capture(&history->capture);
+
+  // Full ring: the slot holds the oldest tick, which is dropped
+  Snapshot* delta = &history->deltas[history->head];
+  if (history->count == SNAPSHOT_HISTORY_TICKS) {
+    history->delta_bytes -= delta->size;
+  } else {
+    history->count++;
+  }
+
+  snapshot_delta_encode(&history->latest, &history->capture, delta);
+  history->delta_bytes += delta->size;
+  history->head = (history->head + 1) % SNAPSHOT_HISTORY_TICKS;
+
+  Snapshot latest  = history->latest;
+  history->latest  = history->capture;
+  history->capture = latest;
+}
+
+bool snapshot_history_rewind(SnapshotHistory* history) {
+  if (history->count == 0) {
+    return false;
+  }
+
+  size_t slot =
+      (history->head + SNAPSHOT_HISTORY_TICKS - 1) % SNAPSHOT_HISTORY_TICKS;
+  const Snapshot* delta = &history->deltas[slot];
+
+  snapshot_delta_apply(&history->latest, delta);
+  history->delta_bytes -= delta->size;
+  history->head = slot;
+  history->count--;
+
+  if (!snapshot_restore(&history->latest)) {
+    snapshot_history_clear(history);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,81 @@
+// snapshot.h - World snapshots for quicksave, quickload and rewind
+//
+// A snapshot is the simulation state of the world in one flat buffer:
+//
+//   header  magic "TTSS", version, layout hash, section sizes, player
+//   ecs     ecs_save: entity table, component storage, system entity order
+//   bodies  x[], y[], vx[], vy[], entities[]
+//   assets  { uint32 handle id, uint32 length, path } per sprite asset
+//   tiles   one TileKind byte per tile
+//
+// Component storage is copied in bulk, so a capture is a few memcpys. Only
+// C_Sprite holds pointers (its CF_Sprite into the asset cache): on restore
+// each sprite acquires its asset again by path and is rebuilt from the cached
+// template, keeping its playback state. Behaviours are plain data and need
+// no fix-up. Derived state (spatial grid, contacts) is rebuilt. Snapshots
+// are native and in memory, so they only restore into the running build;
+// ones taken with other component layouts or another level are refused.
+//
+// SnapshotHistory keeps the last SNAPSHOT_HISTORY_TICKS ticks for rewinding
+// as one full snapshot plus a delta per tick: the XOR of consecutive
+// snapshots, run-length encoded, so bytes that didn't change cost nothing.
+// XOR is its own inverse, so the same delta steps either way.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../config/config.h"
+
+#define SNAPSHOT_MAGIC 0x53535454 // "TTSS"
+#define SNAPSHOT_VERSION 1
+
+#ifndef SNAPSHOT_HISTORY_TICKS
+#define SNAPSHOT_HISTORY_TICKS (SIM_TICK_RATE * 5)
+#endif
+
+// Full snapshot or delta. The buffer is kept and reused by the next capture.
+typedef struct Snapshot {
+  uint8_t* data;
+  size_t size;
+  size_t capacity;
+} Snapshot;
+
+typedef struct SnapshotHistory {
+  Snapshot latest;  // Full state after the newest tick
+  Snapshot capture; // Next full state, swapped with latest
+  Snapshot deltas[SNAPSHOT_HISTORY_TICKS]; // Ring, each to the tick before
+  size_t head;        // Slot of the next delta
+  size_t count;       // Deltas held
+  size_t delta_bytes; // Sum of their sizes, for the debug overlay
+} SnapshotHistory;
+
+void snapshot_free(Snapshot* snapshot);
+
+// Captures the world. Call between ticks, not from a system.
+void snapshot_capture(Snapshot* snapshot);
+
+// Replaces the world with a captured state. Returns false, leaving the world
+// unchanged, if the snapshot doesn't match this build or level.
+bool snapshot_restore(const Snapshot* snapshot);
+
+// Encodes the difference of `a` and `b` into `delta`.
+void snapshot_delta_encode(const Snapshot* a, const Snapshot* b,
+                           Snapshot* delta);
+
+// Turns `snapshot` (one side of the delta) into the other side.
+void snapshot_delta_apply(Snapshot* snapshot, const Snapshot* delta);
+
+void snapshot_history_free(SnapshotHistory* history);
+
+// Forgets every tick, e.g. when component layouts change on hot reload.
+void snapshot_history_clear(SnapshotHistory* history);
+
+// Records the world after a tick, dropping the oldest tick when full.
+void snapshot_history_push(SnapshotHistory* history);
+
+// Restores the world to the tick before the newest one recorded, which
+// becomes the newest. Returns false when there is nothing to go back to.
+bool snapshot_history_rewind(SnapshotHistory* history);
@@ -0,0 +1,181 @@
+// spatial.c - Hashed uniform grid spatial index
+//
+// Build is a counting sort of (cell, item) pairs by bucket, so a query walks
+// contiguous slot ranges. Items spanning several cells are reported once: only
+// from the cell holding the lower corner of the item/query intersection.
+
+#include "spatial.h"
+
+#include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <math.h>
+#include <string.h>
+
+// =============================================================================
+// Cells
+// =============================================================================
+
+static int cell_coord(const SpatialGrid* grid, float v) {
+  return (int)floorf(v / grid->cell_size);
+}
+
+static uint32_t cell_bucket(const SpatialGrid* grid, int x, int y) {
+  uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u;
+  return h & grid->bucket_mask;
+}
+
+// =============================================================================
+// Lifecycle
+// =============================================================================
+
+void spatial_init(SpatialGrid* grid, float cell_size, size_t bucket_count) {
+  CF_ASSERT(cell_size > 0.0f);
+  CF_ASSERT(bucket_count > 0 && (bucket_count & (bucket_count - 1)) == 0);
+
+  *grid              = (SpatialGrid){0};
+  grid->cell_size    = cell_size;
+  grid->bucket_mask  = (uint32_t)(bucket_count - 1);
+  grid->bucket_start = cf_calloc(bucket_count + 1, sizeof(uint32_t));
+  CF_ASSERT(grid->bucket_start);
+}
+
+void spatial_free(SpatialGrid* grid) {
+  cf_free(grid->bucket_start);
+  cf_free(grid->slots);
+  cf_free(grid->items);
+  *grid = (SpatialGrid){0};
+}
+
+// =============================================================================
+// Rebuild
+// =============================================================================
+
+void spatial_clear(SpatialGrid* grid) {
+  grid->count      = 0;
+  grid->slot_count = 0;
+}
+
+void spatial_insert(SpatialGrid* grid, ecs_entity_t entity, CF_Aabb bounds) {
+  if (grid->count == grid->capacity) {
+    grid->capacity = grid->capacity ? grid->capacity * 2 : 256;
+    grid->items =
+        cf_realloc(grid->items, grid->capacity * sizeof(SpatialItem));
+    CF_ASSERT(grid->items);
+  }
+
+  grid->items[grid->count++] = (SpatialItem){entity, bounds};
+}
+
+void spatial_build(SpatialGrid* grid) {
+  size_t bucket_count = (size_t)grid->bucket_mask + 1;
+  memset(grid->bucket_start, 0, (bucket_count + 1) * sizeof(uint32_t));
+
+  // Count slots per bucket
+  size_t slot_count = 0;
+  for (size_t i = 0; i < grid->count; i++) {
+    const CF_Aabb* b = &grid->items[i].bounds;
+    int x0 = cell_coord(grid, b->min.x), x1 = cell_coord(grid, b->max.x);
+    int y0 = cell_coord(grid, b->min.y), y1 = cell_coord(grid, b->max.y);
+
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        grid->bucket_start[cell_bucket(grid, x, y) + 1]++;
+        slot_count++;
+      }
+    }
+  }
+
+  if (slot_count > grid->slot_capacity) {
+    grid->slot_capacity = slot_count;
+    grid->slots = cf_realloc(grid->slots, slot_count * sizeof(uint32_t));
+    CF_ASSERT(grid->slots);
+  }
+  grid->slot_count = slot_count;
+
+  // Prefix sum into start offsets
+  for (size_t i = 0; i < bucket_count; i++) {
+    grid->bucket_start[i + 1] += grid->bucket_start[i];
+  }
+
+  // Scatter; bucket_start[b] is used as a cursor and ends up at the next
+  // bucket's start, so shift back afterwards
+  for (size_t i = 0; i < grid->count; i++) {
+    const CF_Aabb* b = &grid->items[i].bounds;
+    int x0 = cell_coord(grid, b->min.x), x1 = cell_coord(grid, b->max.x);
+    int y0 = cell_coord(grid, b->min.y), y1 = cell_coord(grid, b->max.y);
+
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        grid->slots[grid->bucket_start[cell_bucket(grid, x, y)]++] =
+            (uint32_t)i;
+      }
+    }
+  }
+
+  memmove(grid->bucket_start + 1, grid->bucket_start,
+          bucket_count * sizeof(uint32_t));
+  grid->bucket_start[0] = 0;
+}
+
+// =============================================================================
+// Query
+// =============================================================================
+
+// Writes matches to whichever of `entities` and `indices` is non-null
+static size_t spatial_collect(const SpatialGrid* grid, CF_Aabb area,
+                              ecs_entity_t* entities, uint32_t* indices,
+                              size_t max) {
+  size_t found = 0;
+
+  int x0 = cell_coord(grid, area.min.x), x1 = cell_coord(grid, area.max.x);
+  int y0 = cell_coord(grid, area.min.y), y1 = cell_coord(grid, area.max.y);
+
+  for (int y = y0; y <= y1; y++) {
+    for (int x = x0; x <= x1; x++) {
+      uint32_t bucket = cell_bucket(grid, x, y);
+
+      for (uint32_t s = grid->bucket_start[bucket];
+           s < grid->bucket_start[bucket + 1]; s++) {
+        // Two cells of one item can share a bucket; their slots are adjacent
+        if (s > grid->bucket_start[bucket] &&
+            grid->slots[s - 1] == grid->slots[s]) {
+          continue;
+        }
+
+        const SpatialItem* item = &grid->items[grid->slots[s]];
+        if (!cf_overlaps(item->bounds, area)) {
+          continue;
+        }
+
+        // Report from one cell only (also skips hash collisions)
+        float ref_x = cf_max(item->bounds.min.x, area.min.x);
+        float ref_y = cf_max(item->bounds.min.y, area.min.y);
+        if (cell_coord(grid, ref_x) != x || cell_coord(grid, ref_y) != y) {
+          continue;
+        }
+
+        if (found == max) {
+          return found;
+        }
+        if (entities) {
+          entities[found] = item->entity;
+        } else {
+          indices[found] = grid->slots[s];
+        }
+        found++;
+      }
+    }
+  }
+
+  return found;
+}
+
+size_t spatial_query(const SpatialGrid* grid, CF_Aabb area, ecs_entity_t* out,
+                     size_t max) {
+  return spatial_collect(grid, area, out, nullptr, max);
+}
+
+size_t spatial_query_items(const SpatialGrid* grid, CF_Aabb area,
+                           uint32_t* out, size_t max) {
+  return spatial_collect(grid, area, nullptr, out, max);
+}
@@ -0,0 +1,53 @@
+// spatial.h - Hashed uniform grid spatial index
+//
+// Entities are inserted with a world-space AABB and bucketed into every grid
+// cell the box touches. The grid is rebuilt from C_Transform each update (see
+// sys_index_spatial) and serves render culling as well as gameplay queries.
+// Queries are read-only and may run concurrently once the grid is built.
+
+#pragma once
+
+#include <cute_math.h>
+#include <pico_ecs.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPATIAL_CELL_SIZE 64.0f
+#define SPATIAL_BUCKET_COUNT 1024 // Power of two
+
+typedef struct SpatialItem {
+  ecs_entity_t entity;
+  CF_Aabb bounds;
+} SpatialItem;
+
+typedef struct SpatialGrid {
+  float cell_size;
+  uint32_t bucket_mask;
+  uint32_t* bucket_start; // Bucket -> first slot in `slots` (bucket_count + 1)
+
+  uint32_t* slots; // Item indices grouped by bucket
+  size_t slot_count;
+  size_t slot_capacity;
+
+  SpatialItem* items;
+  size_t count;
+  size_t capacity;
+} SpatialGrid;
+
+void spatial_init(SpatialGrid* grid, float cell_size, size_t bucket_count);
+void spatial_free(SpatialGrid* grid);
+
+// Rebuild: clear, insert every item, then build before querying.
+void spatial_clear(SpatialGrid* grid);
+void spatial_insert(SpatialGrid* grid, ecs_entity_t entity, CF_Aabb bounds);
+void spatial_build(SpatialGrid* grid);
+
+// Writes up to `max` entities overlapping `area` to `out`, each once.
+// Returns the number written.
+size_t spatial_query(const SpatialGrid* grid, CF_Aabb area, ecs_entity_t* out,
+                     size_t max);
+
+// As spatial_query, but writes item indices (insertion order) instead, for
+// callers that keep their own data per inserted item.
+size_t spatial_query_items(const SpatialGrid* grid, CF_Aabb area,
+                           uint32_t* out, size_t max);
@@ -1,31 +1,73 @@
-// animation_system.c - Coroutine-based player state and animation
+// animation_system.c - Sprite playback and stackless player state
 //
-// Single coroutine drives state transitions, animation selection, and sprite
-// updates.
+// sys_advance_animations steps every sprite's clip in one pass and queues
+// the clips that finished. A per-entity state machine then drives state
+// transitions and clip selection; one-shot clips park the behaviour in a wait
+// stored in C_PlayerState (see behavior.h) that the queue releases.
 
-#include <cute_coroutine.h>
 #include <cute_math.h>
 #include <cute_sprite.h>
 #include <stddef.h>
 
+#include "../../engine/arena.h"
 #include "../../engine/game_state.h"
+#include "animation.h"
 #include "systems.h"
 #include "world.h"
 
+// Clip played on entering each state (firing picks its own variant)
+static const AnimClip player_state_clips[PLAYER_STATE_COUNT] = {
+    [PLAYER_STATE_IDLE]           = ANIM_CLIP_GUN_AIM,
+    [PLAYER_STATE_WALKING]        = ANIM_CLIP_GUN_WALK,
+    [PLAYER_STATE_CROUCHING]      = ANIM_CLIP_GUN_CROUCH,
+    [PLAYER_STATE_CROUCH_WALKING] = ANIM_CLIP_GUN_CROUCH,
+    [PLAYER_STATE_FIRING]         = ANIM_CLIP_GUN_FIRE,
+    [PLAYER_STATE_CROUCH_FIRING]  = ANIM_CLIP_GUN_CROUCH_FIRE,
+    [PLAYER_STATE_RELOADING]      = ANIM_CLIP_GUN_RELOAD,
+};
+
 // =============================================================================
-// Coroutine Helpers
+// System: Advance Animations
 // =============================================================================
+// Runs before behaviour, so a clip that finishes this tick is resumed from in
+// the same tick. Sprites that aren't due (C_Lod) wait, then step over the
+// ticks they skipped; behaviour is due on the same ticks, so it still sees
+// every finished clip.
+
+ecs_ret_t sys_advance_animations([[maybe_unused]] ecs_t* ecs,
+                                 ecs_entity_t* entities, size_t count,
+                                 [[maybe_unused]] void* udata) {
+  ecs_view_t sprites = ECS_VIEW(C_Sprite);
+  ecs_view_t lods    = ECS_VIEW(C_Lod);
+  AnimEvents* events = &state->world.animations.finished;
+  Arena* arena       = &state->world.tick_arena;
+  float dt           = state->world.dt;
 
-// Per-frame helper: update facing direction from input, apply sprite flip,
-// update sprite
-static void player_tick(CF_Coroutine co) {
-  GameState* state           = (GameState*)cf_coroutine_get_udata(co);
-  ecs_entity_t player_entity = state->world.player;
+  for (size_t i = 0; i < count; i++) {
+    auto lod = ECS_ROW(lods, C_Lod, entities[i]);
+    if (!lod->due) {
+      continue;
+    }
 
-  auto controller = ECS_GET(player_entity, C_PlayerController);
-  auto input      = ECS_GET(player_entity, C_PlayerInput);
-  auto sprite     = ECS_GET(player_entity, C_Sprite);
+    auto sprite = ECS_ROW(sprites, C_Sprite, entities[i]);
+    if (animation_advance(&sprite->sprite, dt * (float)lod->ticks) &&
+        sprite->clip != ANIM_CLIP_NONE) {
+      ARENA_ARRAY_PUSH(arena, events,
+                       ((AnimEvent){.entity = entities[i],
+                                    .clip   = sprite->clip}));
+    }
+  }
+
+  return 0;
+}
+
+// =============================================================================
+// Behaviour Helpers
+// =============================================================================
 
+// Per-frame helper: update facing direction from input, apply sprite flip
+static void player_tick(C_PlayerController* controller,
+                        const C_PlayerInput* input, CF_Sprite* sprite) {
   // Update facing direction from input
   if (input->right) {
     controller->facing_direction = cf_v2(1.0f, 0.0f);
@@ -39,144 +81,129 @@ static void player_tick(CF_Coroutine co) {
   } else {
     sprite->scale.x = -1.0f;
   }
+}
 
-  // Update sprite animation
-  cf_sprite_update(sprite);
+// Enters a looping state, restarting its clip only on change
+static void player_loop(C_PlayerState* ps, C_Sprite* sprite,
+                        PlayerState next) {
+  ps->current   = next;
+  AnimClip clip = player_state_clips[next];
+  if (sprite->clip != clip) {
+    play_clip(sprite, clip);
+  }
+}
 
-  // Yield to next frame
-  cf_coroutine_yield(co);
+// Starts a one-shot clip and waits before entering `resume`
+static void player_one_shot(C_PlayerState* ps, C_Sprite* sprite,
+                            PlayerState next, AnimClip clip,
+                            BehaviorWait wait, int frame, PlayerState resume) {
+  ps->current = next;
+  play_clip(sprite, clip);
+  behavior_wait(&ps->behavior, wait, clip, frame, (int)resume);
 }
 
-// =============================================================================
-// Coroutine Entry Point
-// =============================================================================
+// Priority-based branching: shoot+crouch > shoot > reload > crouch > walk >
+// idle
+static void player_decide(C_PlayerState* ps, const C_PlayerInput* input,
+                          C_Sprite* sprite, const C_Velocity* velocity) {
+  // Shoot + Crouch → Crouch Fire (one-shot, return to crouching)
+  if (input->shoot && input->crouch) {
+    player_one_shot(ps, sprite, PLAYER_STATE_CROUCH_FIRING,
+                    ANIM_CLIP_GUN_CROUCH_FIRE, BEHAVIOR_WAIT_ANIMATION, 0,
+                    PLAYER_STATE_CROUCHING);
+    return;
+  }
 
-static void player_behavior_fn(CF_Coroutine co) {
-  GameState* state           = (GameState*)cf_coroutine_get_udata(co);
-  ecs_entity_t player_entity = state->world.player;
-
-  while (true) {
-    auto ps       = ECS_GET(player_entity, C_PlayerState);
-    auto input    = ECS_GET(player_entity, C_PlayerInput);
-    auto sprite   = ECS_GET(player_entity, C_Sprite);
-    auto velocity = ECS_GET(player_entity, C_Velocity);
-
-    // Priority-based branching: shoot+crouch > shoot > reload > crouch > walk >
-    // idle
-
-    // Shoot + Crouch → Crouch Fire (one-shot, return to crouching)
-    if (input->shoot && input->crouch) {
-      ps->current = PLAYER_STATE_CROUCH_FIRING;
-      cf_sprite_play(sprite, "GunCrouchFire");
-
-      // Loop until animation finishes
-      while (!cf_sprite_will_finish(sprite)) {
-        player_tick(co);
-      }
-
-      // Return to crouching state
-      ps->current = PLAYER_STATE_CROUCHING;
-      cf_sprite_play(sprite, "GunCrouch");
-      player_tick(co);
-      continue;
+  // Shoot → Fire (one-shot, pick GunWalkFire vs GunFire based on velocity)
+  if (input->shoot) {
+    // GunWalkFire has 8 frames but we only want 4 (one shot); GunFire plays
+    // fully
+    if (velocity->x != 0.0f) {
+      player_one_shot(ps, sprite, PLAYER_STATE_FIRING, ANIM_CLIP_GUN_WALK_FIRE,
+                      BEHAVIOR_WAIT_FRAME, 3, PLAYER_STATE_IDLE);
+    } else {
+      player_one_shot(ps, sprite, PLAYER_STATE_FIRING, ANIM_CLIP_GUN_FIRE,
+                      BEHAVIOR_WAIT_ANIMATION, 0, PLAYER_STATE_IDLE);
     }
+    return;
+  }
 
-    // Shoot → Fire (one-shot, pick GunWalkFire vs GunFire based on velocity)
-    if (input->shoot) {
-      ps->current = PLAYER_STATE_FIRING;
-
-      // Pick animation based on current velocity
-      bool moving           = velocity->x != 0.0f;
-      const char* anim_name = moving ? "GunWalkFire" : "GunFire";
-      cf_sprite_play(sprite, anim_name);
-
-      // GunWalkFire has 8 frames but we only want 4 (one shot)
-      if (moving) {
-        while (cf_sprite_current_frame(sprite) < 3) {
-          player_tick(co);
-        }
-      } else {
-        // GunFire plays fully
-        while (!cf_sprite_will_finish(sprite)) {
-          player_tick(co);
-        }
-      }
-
-      // Return to idle
-      ps->current = PLAYER_STATE_IDLE;
-      cf_sprite_play(sprite, "GunAim");
-      player_tick(co);
-      continue;
-    }
+  // Reload → Reload (one-shot, return to idle)
+  if (input->reload) {
+    player_one_shot(ps, sprite, PLAYER_STATE_RELOADING, ANIM_CLIP_GUN_RELOAD,
+                    BEHAVIOR_WAIT_ANIMATION, 0, PLAYER_STATE_IDLE);
+    return;
+  }
 
-    // Reload → Reload (one-shot, return to idle)
-    if (input->reload) {
-      ps->current = PLAYER_STATE_RELOADING;
-      cf_sprite_play(sprite, "GunReload");
+  // Crouch → Crouching (looping)
+  if (input->crouch) {
+    player_loop(ps, sprite, PLAYER_STATE_CROUCHING);
+    return;
+  }
 
-      // Loop until animation finishes
-      while (!cf_sprite_will_finish(sprite)) {
-        player_tick(co);
-      }
+  // Walk → Walking (looping, requires horizontal velocity)
+  if (velocity->x != 0.0f) {
+    player_loop(ps, sprite, PLAYER_STATE_WALKING);
+    return;
+  }
 
-      // Return to idle
-      ps->current = PLAYER_STATE_IDLE;
-      cf_sprite_play(sprite, "GunAim");
-      player_tick(co);
-      continue;
-    }
+  // Idle → Idle (looping)
+  player_loop(ps, sprite, PLAYER_STATE_IDLE);
+}
 
-    // Crouch → Crouching (looping)
-    if (input->crouch) {
-      ps->current = PLAYER_STATE_CROUCHING;
-      if (!cf_sprite_is_playing(sprite, "GunCrouch")) {
-        cf_sprite_play(sprite, "GunCrouch");
-      }
-      player_tick(co);
-      continue;
+// =============================================================================
+// System: Player Behavior
+// =============================================================================
+// Steps every due player state machine (C_Lod) once per frame. This tick's
+// finished clips release the waits on them first. A new decision is only
+// made when no one-shot is pending; a finished wait plays the resume state's
+// clip and hands control back to player_decide on the next frame.
+
+ecs_ret_t sys_player_behavior(ecs_t* ecs, ecs_entity_t* entities,
+                              size_t count, [[maybe_unused]] void* udata) {
+  ecs_view_t states      = ECS_VIEW(C_PlayerState);
+  ecs_view_t inputs      = ECS_VIEW(C_PlayerInput);
+  ecs_view_t controllers = ECS_VIEW(C_PlayerController);
+  ecs_view_t sprites     = ECS_VIEW(C_Sprite);
+  ecs_view_t velocities  = ECS_VIEW(C_Velocity);
+  ecs_view_t lods        = ECS_VIEW(C_Lod);
+
+  // Events cover every sprite, not only player ones
+  const AnimEvents* finished = &state->world.animations.finished;
+  ecs_comp_t player_state    = ECS_GET_COMP(C_PlayerState);
+
+  for (size_t i = 0; i < finished->count; i++) {
+    const AnimEvent* event = &finished->items[i];
+    if (ecs_has(ecs, event->entity, player_state)) {
+      auto ps = ECS_ROW(states, C_PlayerState, event->entity);
+      behavior_clip_finished(&ps->behavior, event->clip);
     }
+  }
 
-    // Walk → Walking (looping, requires horizontal velocity)
-    if (velocity->x != 0.0f) {
-      ps->current = PLAYER_STATE_WALKING;
-      if (!cf_sprite_is_playing(sprite, "GunWalk")) {
-        cf_sprite_play(sprite, "GunWalk");
-      }
-      player_tick(co);
+  for (size_t i = 0; i < count; i++) {
+    if (!ECS_ROW(lods, C_Lod, entities[i])->due) {
       continue;
     }
 
-    // Idle → Idle (looping)
-    ps->current = PLAYER_STATE_IDLE;
-    if (!cf_sprite_is_playing(sprite, "GunAim")) {
-      cf_sprite_play(sprite, "GunAim");
-    }
-    player_tick(co);
-  }
-}
-
-// =============================================================================
-// System: Player Coroutine
-// =============================================================================
-// Resumes player coroutine each frame, creates it if dead/uninitialized
+    auto ps         = ECS_ROW(states, C_PlayerState, entities[i]);
+    auto input      = ECS_ROW(inputs, C_PlayerInput, entities[i]);
+    auto controller = ECS_ROW(controllers, C_PlayerController, entities[i]);
+    auto sprite     = ECS_ROW(sprites, C_Sprite, entities[i]);
+    auto velocity   = ECS_ROW(velocities, C_Velocity, entities[i]);
 
-// NOLINTBEGIN
-ecs_ret_t sys_player_coroutine([[maybe_unused]] ecs_t* ecs,
-                               ecs_entity_t* entities, size_t count,
-                               [[maybe_unused]] void* udata) {
-  for (size_t i = 0; i < count; i++) {
-    auto ps = ECS_GET(entities[i], C_PlayerState);
+    if (ps->behavior.wait == BEHAVIOR_WAIT_NONE) {
+      player_decide(ps, input, sprite, velocity);
+    }
 
-    // Create coroutine if uninitialized or dead
-    if (ps->co.id == 0 ||
-        cf_coroutine_state(ps->co) == CF_COROUTINE_STATE_DEAD) {
-      ps->co = cf_make_coroutine(player_behavior_fn, 0, state);
+    if (ps->behavior.wait != BEHAVIOR_WAIT_NONE &&
+        behavior_ready(&ps->behavior, &sprite->sprite)) {
+      ps->current = (PlayerState)ps->behavior.resume;
+      play_clip(sprite, player_state_clips[ps->current]);
+      behavior_wait(&ps->behavior, BEHAVIOR_WAIT_NONE, ANIM_CLIP_NONE, 0, 0);
     }
 
-    // Resume coroutine
-    cf_coroutine_resume(ps->co);
+    player_tick(controller, input, &sprite->sprite);
   }
 
   return 0;
 }
-// NOLINTEND
@@ -0,0 +1,45 @@
+// asset_system.c - Streamed sprite hand-off
+//
+// Entities whose sprite was still loading when they were created draw the
+// asset placeholder. Once the cache reports the sprite ready, they get a fresh
+// playback instance, the asset's clip table is resolved and they lose their
+// C_SpriteLoading tag. A failed load keeps the placeholder but drops the tag
+// too, so the entity isn't waited on (or visited here) forever.
+
+#include <cute_sprite.h>
+#include <stddef.h>
+
+#include "../../engine/asset.h"
+#include "../../engine/game_state.h"
+#include "systems.h"
+#include "world.h"
+
+ecs_ret_t sys_resolve_sprites(ecs_t* ecs, ecs_entity_t* entities, size_t count,
+                              [[maybe_unused]] void* udata) {
+  ecs_view_t sprites = ECS_VIEW(C_Sprite);
+
+  for (size_t i = 0; i < count; i++) {
+    auto sprite = ECS_ROW(sprites, C_Sprite, entities[i]);
+    if (!asset_is_settled(&state->assets, sprite->asset)) {
+      continue;
+    }
+
+    // Removed at the stage flush, so later stages see the final sprite
+    ecs_queue_remove(ecs, entities[i], ECS_GET_COMP(C_SpriteLoading));
+
+    if (!asset_is_ready(&state->assets, sprite->asset)) {
+      continue; // Failed, logged by the cache
+    }
+
+    // Keep the facing flip set while on the placeholder
+    float scale_x          = sprite->sprite.scale.x;
+    sprite->sprite         = asset_sprite(&state->assets, sprite->asset);
+    sprite->sprite.scale.x = scale_x;
+    sprite->clip           = ANIM_CLIP_NONE;
+
+    animations_resolve(&state->world.animations, &state->assets,
+                       sprite->asset, &sprite->sprite);
+  }
+
+  return 0;
+}
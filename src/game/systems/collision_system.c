@@ -0,0 +1,46 @@
+// collision_system.c - Collider proxies and contact generation
+//
+// Turns every C_Collider into a world-space proxy at its transform and runs
+// the broadphase and narrowphase. Runs on the main thread after the spatial
+// index, since contacts are pushed to the (single-threaded) tick arena.
+
+#include <cute_math.h>
+#include <stddef.h>
+
+#include "../../engine/arena.h"
+#include "../../engine/game_state.h"
+#include "collision.h"
+#include "systems.h"
+#include "world.h"
+
+ecs_ret_t sys_detect_collisions([[maybe_unused]] ecs_t* ecs,
+                                ecs_entity_t* entities, size_t count,
+                                [[maybe_unused]] void* udata) {
+  Collisions* collisions = &state->world.collisions;
+
+  ecs_view_t colliders  = ECS_VIEW(C_Collider);
+  ecs_view_t transforms = ECS_VIEW(C_Transform);
+
+  collisions_clear(collisions);
+
+  for (size_t i = 0; i < count; i++) {
+    const C_Collider* c = ECS_ROW(colliders, C_Collider, entities[i]);
+    CF_V2 position = ECS_ROW(transforms, C_Transform, entities[i])->position;
+
+    ColliderProxy proxy = {
+        .entity       = entities[i],
+        .shape        = c->shape,
+        .center       = cf_add(position, c->offset),
+        .half_extents = c->shape == COLLIDER_CIRCLE
+                            ? cf_v2(c->radius, c->radius)
+                            : c->half_extents,
+        .layer        = c->layer,
+        .mask         = c->mask,
+    };
+    collisions_add(collisions, &proxy);
+  }
+
+  collisions_detect(collisions, &state->world.tick_arena);
+
+  return 0;
+}
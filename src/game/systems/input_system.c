@@ -1,32 +1,83 @@
 // input_system.c - Input gathering system
 //
 // Reads keyboard state and populates the input component.
-// Movement uses held state, actions use single-frame triggers.
+// Movement uses held state, actions use single-frame triggers. Input is
+// sampled once per tick as a bit set (the replay stream format), so recorded
+// sessions feed back through the same path. CF polls input once per displayed
+// frame, which runs any number of ticks, so action presses are latched per
+// frame and taken by the next tick: none is dropped or seen twice.
 
 #include <cute_input.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "../../engine/game_state.h"
 #include "systems.h"
 #include "world.h"
 
+// One bit per C_PlayerInput field. Stored in recordings: append only.
+enum {
+  INPUT_BIT_UP     = 1 << 0,
+  INPUT_BIT_DOWN   = 1 << 1,
+  INPUT_BIT_LEFT   = 1 << 2,
+  INPUT_BIT_RIGHT  = 1 << 3,
+  INPUT_BIT_CROUCH = 1 << 4,
+  INPUT_BIT_SHOOT  = 1 << 5,
+  INPUT_BIT_RELOAD = 1 << 6,
+};
+
+static uint8_t input_bit(bool on, int bit) { return on ? (uint8_t)bit : 0; }
+
+void latch_input_edges(void) {
+  uint8_t bits = 0;
+
+  // Action triggers (single-frame)
+  bits |= input_bit(cf_mouse_just_pressed(CF_MOUSE_BUTTON_LEFT),
+                    INPUT_BIT_SHOOT);
+  bits |= input_bit(cf_key_just_pressed(CF_KEY_R), INPUT_BIT_RELOAD);
+
+  state->pending_input |= bits;
+}
+
+uint8_t read_input_bits(void) {
+  // Presses latched since the last tick
+  uint8_t bits         = state->pending_input;
+  state->pending_input = 0;
+
+  // Movement directions (held state)
+  bits |= input_bit(cf_key_down(CF_KEY_W) || cf_key_down(CF_KEY_UP),
+                    INPUT_BIT_UP);
+  bits |= input_bit(cf_key_down(CF_KEY_S) || cf_key_down(CF_KEY_DOWN),
+                    INPUT_BIT_DOWN);
+  bits |= input_bit(cf_key_down(CF_KEY_A) || cf_key_down(CF_KEY_LEFT),
+                    INPUT_BIT_LEFT);
+  bits |= input_bit(cf_key_down(CF_KEY_D) || cf_key_down(CF_KEY_RIGHT),
+                    INPUT_BIT_RIGHT);
+
+  // Movement modifiers (held state)
+  bits |= input_bit(cf_key_down(CF_KEY_LCTRL), INPUT_BIT_CROUCH);
+
+  return bits;
+}
+
 ecs_ret_t sys_gather_input([[maybe_unused]] ecs_t* ecs, ecs_entity_t* entities,
                            size_t count, [[maybe_unused]] void* udata) {
-  for (size_t i = 0; i < count; ++i) {
-    auto input = ECS_GET(entities[i], C_PlayerInput);
+  uint8_t bits = state->world.input_bits;
 
-    // Movement directions (held state)
-    input->up    = cf_key_down(CF_KEY_W) || cf_key_down(CF_KEY_UP);
-    input->down  = cf_key_down(CF_KEY_S) || cf_key_down(CF_KEY_DOWN);
-    input->left  = cf_key_down(CF_KEY_A) || cf_key_down(CF_KEY_LEFT);
-    input->right = cf_key_down(CF_KEY_D) || cf_key_down(CF_KEY_RIGHT);
+  C_PlayerInput sample = {
+      .up     = bits & INPUT_BIT_UP,
+      .down   = bits & INPUT_BIT_DOWN,
+      .left   = bits & INPUT_BIT_LEFT,
+      .right  = bits & INPUT_BIT_RIGHT,
+      .crouch = bits & INPUT_BIT_CROUCH,
+      .shoot  = bits & INPUT_BIT_SHOOT,
+      .reload = bits & INPUT_BIT_RELOAD,
+  };
 
-    // Movement modifiers (held state)
-    input->crouch = cf_key_down(CF_KEY_LCTRL);
+  ecs_view_t inputs = ECS_VIEW(C_PlayerInput);
 
-    // Action triggers (single-frame)
-    input->shoot  = cf_mouse_just_pressed(CF_MOUSE_BUTTON_LEFT);
-    input->reload = cf_key_just_pressed(CF_KEY_R);
+  for (size_t i = 0; i < count; ++i) {
+    *ECS_ROW(inputs, C_PlayerInput, entities[i]) = sample;
   }
 
   return 0;
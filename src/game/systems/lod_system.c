@@ -0,0 +1,75 @@
+// lod_system.c - Level of detail by distance from the camera
+//
+// sys_update_lod runs before animation and behaviour each tick. Distance is
+// measured outside the camera rect along the larger axis, so everything on
+// screen is at distance zero and no square root is needed.
+
+#include <cute_math.h>
+#include <cute_multithreading.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../engine/game_state.h"
+#include "systems.h"
+#include "world.h"
+
+#define LOD_LEVEL_INTERVAL(ID, NAME, INTERVAL) [ID] = INTERVAL,
+
+// Ticks between updates per level; powers of two
+static const uint32_t lod_intervals[LOD_LEVEL_COUNT] = {
+    LOD_LEVELS(LOD_LEVEL_INTERVAL)};
+
+#undef LOD_LEVEL_INTERVAL
+
+static LodLevel lod_level(CF_Aabb camera, CF_V2 position) {
+  CF_V2 below    = cf_sub(camera.min, position);
+  CF_V2 above    = cf_sub(position, camera.max);
+  float dx       = cf_max(cf_max(below.x, above.x), 0.0f);
+  float dy       = cf_max(cf_max(below.y, above.y), 0.0f);
+  float distance = cf_max(dx, dy);
+
+  if (distance <= LOD_VISIBLE_MARGIN) {
+    return LOD_LEVEL_VISIBLE;
+  }
+  return distance <= LOD_NEAR_DISTANCE ? LOD_LEVEL_NEAR : LOD_LEVEL_FAR;
+}
+
+// Runs in worker batches; counts are summed per batch before touching the
+// shared stats
+ecs_ret_t sys_update_lod([[maybe_unused]] ecs_t* ecs, ecs_entity_t* entities,
+                         size_t count, [[maybe_unused]] void* udata) {
+  ecs_view_t transforms = ECS_VIEW(C_Transform);
+  ecs_view_t lods       = ECS_VIEW(C_Lod);
+
+  const World* world = &state->world;
+  uint32_t tick      = world->tick;
+
+  int levels[LOD_LEVEL_COUNT] = {0};
+  int due                     = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    auto lod       = ECS_ROW(lods, C_Lod, entities[i]);
+    auto transform = ECS_ROW(transforms, C_Transform, entities[i]);
+
+    // The player is always looked at, wherever the camera is
+    LodLevel level = entities[i].id == world->player.id
+                         ? LOD_LEVEL_VISIBLE
+                         : lod_level(world->camera, transform->position);
+
+    // Start counting again after an update. Two intervals at most, so it
+    // can't overflow.
+    lod->ticks = lod->due ? 1 : (uint8_t)(lod->ticks + 1);
+    lod->level = (uint8_t)level;
+    lod->due   = ((tick + entities[i].id) & (lod_intervals[level] - 1)) == 0;
+
+    levels[level]++;
+    due += lod->due;
+  }
+
+  for (int i = 0; i < LOD_LEVEL_COUNT; i++) {
+    cf_atomic_add(&state->world.lod.entities[i], levels[i]);
+  }
+  cf_atomic_add(&state->world.lod.due, due);
+
+  return 0;
+}
@@ -1,6 +1,8 @@
 // physics_system.c - Physics integration system
 //
 // Integrates velocity into position using simple Euler integration.
+// C_Body entities are integrated in bulk from the SoA body arrays. Positions
+// are snapshotted first so rendering can interpolate between ticks.
 
 #include <cute_math.h>
 #include <stddef.h>
@@ -9,14 +11,32 @@
 #include "systems.h"
 #include "world.h"
 
+// Runs before anything moves this tick
+ecs_ret_t sys_snapshot_transforms([[maybe_unused]] ecs_t* ecs,
+                                  ecs_entity_t* entities, size_t count,
+                                  [[maybe_unused]] void* udata) {
+  ecs_view_t transforms = ECS_VIEW(C_Transform);
+
+  for (size_t i = 0; i < count; i++) {
+    auto transform          = ECS_ROW(transforms, C_Transform, entities[i]);
+    transform->previous     = transform->position;
+    transform->has_previous = true;
+  }
+
+  return 0;
+}
+
 ecs_ret_t sys_apply_velocity([[maybe_unused]] ecs_t* ecs,
                              ecs_entity_t* entities, size_t count,
                              [[maybe_unused]] void* udata) {
   float dt = state->world.dt;
 
+  ecs_view_t transforms = ECS_VIEW(C_Transform);
+  ecs_view_t velocities = ECS_VIEW(C_Velocity);
+
   for (size_t i = 0; i < count; i++) {
-    auto transform = ECS_GET(entities[i], C_Transform);
-    auto velocity  = ECS_GET(entities[i], C_Velocity);
+    auto transform = ECS_ROW(transforms, C_Transform, entities[i]);
+    auto velocity  = ECS_ROW(velocities, C_Velocity, entities[i]);
 
     // Simple Euler integration: position += velocity * dt
     transform->position = cf_add(transform->position, cf_mul(*velocity, dt));
@@ -24,3 +44,34 @@ ecs_ret_t sys_apply_velocity([[maybe_unused]] ecs_t* ecs,
 
   return 0;
 }
+
+// Integrates every body in one pass over the SoA arrays. The entity list is
+// not needed: rows are dense, so the kernel runs over [0, count).
+ecs_ret_t sys_integrate_bodies([[maybe_unused]] ecs_t* ecs,
+                               [[maybe_unused]] ecs_entity_t* entities,
+                               [[maybe_unused]] size_t count,
+                               [[maybe_unused]] void* udata) {
+  Bodies* bodies = &state->world.bodies;
+  bodies_integrate(bodies, 0, bodies->count, state->world.dt);
+
+  return 0;
+}
+
+// Copies integrated body positions back into C_Transform for rendering.
+ecs_ret_t sys_sync_body_transforms([[maybe_unused]] ecs_t* ecs,
+                                   ecs_entity_t* entities, size_t count,
+                                   [[maybe_unused]] void* udata) {
+  const Bodies* bodies = &state->world.bodies;
+
+  ecs_view_t transforms = ECS_VIEW(C_Transform);
+  ecs_view_t body_rows  = ECS_VIEW(C_Body);
+
+  for (size_t i = 0; i < count; i++) {
+    auto transform = ECS_ROW(transforms, C_Transform, entities[i]);
+    size_t row     = ECS_ROW(body_rows, C_Body, entities[i])->row;
+
+    transform->position = cf_v2(bodies->x[row], bodies->y[row]);
+  }
+
+  return 0;
+}
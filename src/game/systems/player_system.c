@@ -18,11 +18,16 @@
 ecs_ret_t sys_update_player_movement([[maybe_unused]] ecs_t* ecs,
                                      ecs_entity_t* entities, size_t count,
                                      [[maybe_unused]] void* udata) {
+  ecs_view_t velocities  = ECS_VIEW(C_Velocity);
+  ecs_view_t controllers = ECS_VIEW(C_PlayerController);
+  ecs_view_t states      = ECS_VIEW(C_PlayerState);
+  ecs_view_t inputs      = ECS_VIEW(C_PlayerInput);
+
   for (size_t i = 0; i < count; i++) {
-    auto velocity   = ECS_GET(entities[i], C_Velocity);
-    auto controller = ECS_GET(entities[i], C_PlayerController);
-    auto ps         = ECS_GET(entities[i], C_PlayerState);
-    auto input      = ECS_GET(entities[i], C_PlayerInput);
+    auto velocity   = ECS_ROW(velocities, C_Velocity, entities[i]);
+    auto controller = ECS_ROW(controllers, C_PlayerController, entities[i]);
+    auto ps         = ECS_ROW(states, C_PlayerState, entities[i]);
+    auto input      = ECS_ROW(inputs, C_PlayerInput, entities[i]);
 
     // No movement while crouching
     if (ps->current == PLAYER_STATE_CROUCHING ||
@@ -1,25 +1,64 @@
-// render_system.c - Sprite rendering system
+// render_system.c - Sprite draw recording
 //
-// Draws all entities with Sprite and Transform components.
+// Records the given Sprite and Transform entities into a draw list (see
+// draw_list.h): a copy of each sprite with both positions of the tick, sorted
+// by layer and source sprite so same-atlas draws are adjacent. Runs on a
+// worker; it only reads the world.
 
-#include <cute_draw.h>
+#include <cute_c_runtime.h>
+#include <cute_math.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 
 #include "../../engine/game_state.h"
+#include "draw_list.h"
 #include "systems.h"
 #include "world.h"
 
-ecs_ret_t sys_render_sprites([[maybe_unused]] ecs_t* ecs,
+// Layer first, then the interned sprite name as a proxy for its texture
+static int compare_draw_sprites(const void* lhs, const void* rhs) {
+  const DrawSprite* a = lhs;
+  const DrawSprite* b = rhs;
+
+  if (a->layer != b->layer) {
+    return a->layer < b->layer ? -1 : 1;
+  }
+
+  uintptr_t a_name = (uintptr_t)a->sprite.name;
+  uintptr_t b_name = (uintptr_t)b->sprite.name;
+  if (a_name != b_name) {
+    return a_name < b_name ? -1 : 1;
+  }
+
+  return a->order < b->order ? -1 : a->order > b->order;
+}
+
+ecs_ret_t sys_record_sprites([[maybe_unused]] ecs_t* ecs,
                              ecs_entity_t* entities, size_t count,
-                             [[maybe_unused]] void* udata) {
+                             void* udata) {
+  DrawList* list = udata;
+  CF_ASSERT(count <= list->capacity);
+  list->count = count;
+
+  ecs_view_t sprites    = ECS_VIEW(C_Sprite);
+  ecs_view_t transforms = ECS_VIEW(C_Transform);
+
   for (size_t i = 0; i < count; i++) {
-    auto sprite    = ECS_GET(entities[i], C_Sprite);
-    auto transform = ECS_GET(entities[i], C_Transform);
+    auto sprite    = ECS_ROW(sprites, C_Sprite, entities[i]);
+    auto transform = ECS_ROW(transforms, C_Transform, entities[i]);
 
-    cf_draw_push();
-    cf_draw_translate(transform->position.x, transform->position.y);
-    cf_draw_sprite(sprite);
-    cf_draw_pop();
+    // Transforms created during the tick have nothing to interpolate from
+    list->sprites[i] = (DrawSprite){
+        .sprite   = sprite->sprite,
+        .previous = transform->has_previous ? transform->previous
+                                            : transform->position,
+        .position = transform->position,
+        .layer    = (uint32_t)sprite->layer,
+        .order    = (uint32_t)i,
+    };
   }
+
+  qsort(list->sprites, count, sizeof(DrawSprite), compare_draw_sprites);
   return 0;
 }
@@ -0,0 +1,42 @@
+// spatial_system.c - Spatial index maintenance
+//
+// Rebuilds the world's spatial grid from C_Transform after physics. Sprite
+// entities are indexed by their drawn bounds, everything else as a point.
+
+#include <cute_math.h>
+#include <stddef.h>
+
+#include "../../engine/game_state.h"
+#include "spatial.h"
+#include "systems.h"
+#include "world.h"
+
+ecs_ret_t sys_index_spatial(ecs_t* ecs, ecs_entity_t* entities, size_t count,
+                            [[maybe_unused]] void* udata) {
+  SpatialGrid* grid = &state->world.spatial;
+  ecs_comp_t sprite = ECS_GET_COMP(C_Sprite);
+
+  ecs_view_t transforms = ECS_VIEW(C_Transform);
+  ecs_view_t sprites    = ECS_VIEW(C_Sprite);
+
+  spatial_clear(grid);
+
+  for (size_t i = 0; i < count; i++) {
+    CF_V2 position = ECS_ROW(transforms, C_Transform, entities[i])->position;
+    CF_Aabb bounds = cf_make_aabb(position, position);
+
+    if (ecs_has(ecs, entities[i], sprite)) {
+      const CF_Sprite* s = &ECS_ROW(sprites, C_Sprite, entities[i])->sprite;
+      CF_V2 half         = cf_v2((float)s->w * cf_abs(s->scale.x) * 0.5f,
+                                 (float)s->h * cf_abs(s->scale.y) * 0.5f);
+      bounds = cf_make_aabb_center_half_extents(cf_add(position, s->offset),
+                                                half);
+    }
+
+    spatial_insert(grid, entities[i], bounds);
+  }
+
+  spatial_build(grid);
+
+  return 0;
+}
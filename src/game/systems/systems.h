@@ -10,20 +10,54 @@
 
 #include "../world.h"
 
-// Input system - reads keyboard/mouse state into C_PlayerInput
+// LOD system - picks update rates by distance from the camera
+ecs_ret_t sys_update_lod(ecs_t* ecs, ecs_entity_t* entities, size_t count,
+                         void* udata);
+
+// Asset system - swaps placeholder sprites for loaded ones
+ecs_ret_t sys_resolve_sprites(ecs_t* ecs, ecs_entity_t* entities, size_t count,
+                              void* udata);
+
+// Animation system - advances every sprite's clip, queueing finished clips
+ecs_ret_t sys_advance_animations(ecs_t* ecs, ecs_entity_t* entities,
+                                 size_t count, void* udata);
+
+// Input system - latches action presses once per frame, samples held state
+// once per tick, then copies the (possibly replayed) sample into every
+// C_PlayerInput
+void latch_input_edges(void);
+uint8_t read_input_bits(void);
 ecs_ret_t sys_gather_input(ecs_t* ecs, ecs_entity_t* entities, size_t count,
                            void* udata);
 
-// Player systems - coroutine-based state and movement
-ecs_ret_t sys_player_coroutine(ecs_t* ecs, ecs_entity_t* entities, size_t count,
-                               void* udata);
+// Player systems - stackless state machine and movement
+ecs_ret_t sys_player_behavior(ecs_t* ecs, ecs_entity_t* entities, size_t count,
+                              void* udata);
 ecs_ret_t sys_update_player_movement(ecs_t* ecs, ecs_entity_t* entities,
                                      size_t count, void* udata);
 
+// Physics system - records positions for render interpolation
+ecs_ret_t sys_snapshot_transforms(ecs_t* ecs, ecs_entity_t* entities,
+                                  size_t count, void* udata);
+
 // Physics system - Euler integration
 ecs_ret_t sys_apply_velocity(ecs_t* ecs, ecs_entity_t* entities, size_t count,
                              void* udata);
 
-// Render system - draws sprites at transform positions
-ecs_ret_t sys_render_sprites(ecs_t* ecs, ecs_entity_t* entities, size_t count,
+// Physics systems - SoA body integration and C_Transform write-back
+ecs_ret_t sys_integrate_bodies(ecs_t* ecs, ecs_entity_t* entities,
+                               size_t count, void* udata);
+ecs_ret_t sys_sync_body_transforms(ecs_t* ecs, ecs_entity_t* entities,
+                                   size_t count, void* udata);
+
+// Spatial system - rebuilds the spatial grid from C_Transform
+ecs_ret_t sys_index_spatial(ecs_t* ecs, ecs_entity_t* entities, size_t count,
+                            void* udata);
+
+// Collision system - collider proxies, broadphase and contacts
+ecs_ret_t sys_detect_collisions(ecs_t* ecs, ecs_entity_t* entities,
+                                size_t count, void* udata);
+
+// Render system - records sprites into a DrawList (udata) for replay
+ecs_ret_t sys_record_sprites(ecs_t* ecs, ecs_entity_t* entities, size_t count,
                              void* udata);
@@ -0,0 +1,295 @@
+// tilemap.c - Chunked static level geometry
+//
+// Tiles are flat-colour boxes until the level has a tileset; only bake_chunk
+// knows how a tile looks, so swapping in sprites later leaves the chunking
+// and culling alone.
+
+#include "tilemap.h"
+
+#include <cute_alloc.h>
+#include <cute_c_runtime.h>
+#include <cute_color.h>
+#include <cute_draw.h>
+#include <cute_file_system.h>
+#include <cute_graphics.h>
+#include <cute_math.h>
+#include <math.h>
+#include <stddef.h>
+
+#include "../config/config.h"
+#include "../engine/log.h"
+
+// Fill per TileKind, and the part of the tile it covers (platforms are a ledge)
+static const struct {
+  uint8_t r, g, b;
+  float height; // Fraction of the tile, from the top
+} tile_styles[TILE_KIND_COUNT] = {
+    [TILE_GROUND]   = {86, 62, 48, 1.0f},
+    [TILE_PLATFORM] = {132, 110, 84, 0.375f},
+    [TILE_CRATE]    = {168, 116, 56, 1.0f},
+};
+
+// =============================================================================
+// Chunks
+// =============================================================================
+
+static TilemapChunk* chunk_at(Tilemap* tilemap, int x, int y) {
+  int cx = x / TILEMAP_CHUNK_TILES;
+  int cy = y / TILEMAP_CHUNK_TILES;
+  return &tilemap->chunks[cy * tilemap->chunks_x + cx];
+}
+
+// Chunk coordinate of a map-relative position, clamped to [0, count - 1]
+static int chunk_coord(float v, int count) {
+  int c = (int)floorf(v / TILEMAP_CHUNK_SIZE);
+  return c < 0 ? 0 : c >= count ? count - 1 : c;
+}
+
+// Chunks overlapping `area`; false if there are none
+static bool chunk_range(const Tilemap* tilemap, CF_Aabb area, int* x0,
+                        int* y0, int* x1, int* y1) {
+  CF_V2 min = cf_sub(area.min, tilemap->origin);
+  CF_V2 max = cf_sub(area.max, tilemap->origin);
+
+  float width  = (float)(tilemap->chunks_x * TILEMAP_CHUNK_SIZE);
+  float height = (float)(tilemap->chunks_y * TILEMAP_CHUNK_SIZE);
+  if (max.x < 0.0f || max.y < 0.0f || min.x >= width || min.y >= height) {
+    return false; // Also covers an empty map
+  }
+
+  *x0 = chunk_coord(min.x, tilemap->chunks_x);
+  *y0 = chunk_coord(min.y, tilemap->chunks_y);
+  *x1 = chunk_coord(max.x, tilemap->chunks_x);
+  *y1 = chunk_coord(max.y, tilemap->chunks_y);
+  return true;
+}
+
+static CF_V2 chunk_center(const Tilemap* tilemap, int cx, int cy) {
+  CF_V2 offset = cf_v2(((float)cx + 0.5f) * TILEMAP_CHUNK_SIZE,
+                       ((float)cy + 0.5f) * TILEMAP_CHUNK_SIZE);
+  return cf_add(tilemap->origin, offset);
+}
+
+// Draws the chunk's tiles centered on the origin and renders them into its
+// canvas. The caller sets a chunk-sized projection.
+static void bake_chunk(Tilemap* tilemap, int cx, int cy) {
+  TilemapChunk* chunk = &tilemap->chunks[cy * tilemap->chunks_x + cx];
+
+  if (!chunk->has_canvas) {
+    chunk->canvas = cf_make_canvas(
+        cf_canvas_defaults(TILEMAP_CHUNK_SIZE, TILEMAP_CHUNK_SIZE));
+    chunk->has_canvas = true;
+  }
+
+  float half = TILEMAP_CHUNK_SIZE * 0.5f;
+  int tx0    = cx * TILEMAP_CHUNK_TILES;
+  int ty0    = cy * TILEMAP_CHUNK_TILES;
+
+  // One colour push per kind rather than per tile
+  for (int kind = TILE_EMPTY + 1; kind < TILE_KIND_COUNT; kind++) {
+    cf_draw_push_color(cf_make_color_rgb(
+        tile_styles[kind].r, tile_styles[kind].g, tile_styles[kind].b));
+
+    for (int y = 0; y < TILEMAP_CHUNK_TILES; y++) {
+      for (int x = 0; x < TILEMAP_CHUNK_TILES; x++) {
+        if (tilemap_get(tilemap, tx0 + x, ty0 + y) != (TileKind)kind) {
+          continue;
+        }
+
+        float left = (float)(x * TILEMAP_TILE_SIZE) - half;
+        float top  = (float)((y + 1) * TILEMAP_TILE_SIZE) - half;
+        float h    = TILEMAP_TILE_SIZE * tile_styles[kind].height;
+        cf_draw_box_fill(cf_make_aabb(cf_v2(left, top - h),
+                                      cf_v2(left + TILEMAP_TILE_SIZE, top)),
+                         0.0f);
+      }
+    }
+
+    cf_draw_pop_color();
+  }
+
+  cf_render_to(chunk->canvas, true);
+  chunk->dirty = false;
+}
+
+// =============================================================================
+// Loading
+// =============================================================================
+
+static TileKind tile_from_char(char c) {
+  switch (c) {
+  case '#':
+    return TILE_GROUND;
+  case '=':
+    return TILE_PLATFORM;
+  case 'X':
+    return TILE_CRATE;
+  default:
+    return TILE_EMPTY;
+  }
+}
+
+bool tilemap_load(Tilemap* tilemap, const char* path, CF_V2 origin) {
+  tilemap_free(tilemap);
+
+  size_t size = 0;
+  char* text  = cf_fs_read_entire_file_to_memory(path, &size);
+  if (!text) {
+    log_error("tilemap", "Failed to read %s", path);
+    return false;
+  }
+
+  // Size: longest line by line count (a trailing newline adds no row)
+  int width = 0, height = 0, column = 0;
+  for (size_t i = 0; i < size; i++) {
+    if (text[i] == '\n') {
+      width = column > width ? column : width;
+      height++;
+      column = 0;
+    } else if (text[i] != '\r') {
+      column++;
+    }
+  }
+  if (column > 0) {
+    width = column > width ? column : width;
+    height++;
+  }
+
+  if (width == 0 || height == 0) {
+    log_error("tilemap", "%s has no tiles", path);
+    cf_free(text);
+    return false;
+  }
+
+  tilemap->width    = width;
+  tilemap->height   = height;
+  tilemap->origin   = origin;
+  tilemap->tiles    = cf_calloc((size_t)width * (size_t)height, 1);
+  tilemap->chunks_x = (width + TILEMAP_CHUNK_TILES - 1) / TILEMAP_CHUNK_TILES;
+  tilemap->chunks_y = (height + TILEMAP_CHUNK_TILES - 1) / TILEMAP_CHUNK_TILES;
+  tilemap->chunks =
+      cf_calloc((size_t)tilemap->chunks_x * (size_t)tilemap->chunks_y,
+                sizeof(TilemapChunk));
+  CF_ASSERT(tilemap->tiles && tilemap->chunks);
+
+  // The file lists the top row first
+  int row = height - 1;
+  column  = 0;
+  for (size_t i = 0; i < size; i++) {
+    if (text[i] == '\n') {
+      row--;
+      column = 0;
+    } else if (text[i] != '\r') {
+      tilemap_set(tilemap, column++, row, tile_from_char(text[i]));
+    }
+  }
+
+  cf_free(text);
+
+  log_info("tilemap", "Loaded %s: %dx%d tiles in %dx%d chunks", path, width,
+           height, tilemap->chunks_x, tilemap->chunks_y);
+  return true;
+}
+
+void tilemap_free(Tilemap* tilemap) {
+  int chunk_count = tilemap->chunks_x * tilemap->chunks_y;
+  for (int i = 0; i < chunk_count; i++) {
+    if (tilemap->chunks[i].has_canvas) {
+      cf_destroy_canvas(tilemap->chunks[i].canvas);
+    }
+  }
+
+  cf_free(tilemap->chunks);
+  cf_free(tilemap->tiles);
+  *tilemap = (Tilemap){0};
+}
+
+// =============================================================================
+// Tiles
+// =============================================================================
+
+TileKind tilemap_get(const Tilemap* tilemap, int x, int y) {
+  if (x < 0 || y < 0 || x >= tilemap->width || y >= tilemap->height) {
+    return TILE_EMPTY;
+  }
+  return (TileKind)tilemap->tiles[y * tilemap->width + x];
+}
+
+void tilemap_set(Tilemap* tilemap, int x, int y, TileKind kind) {
+  if (x < 0 || y < 0 || x >= tilemap->width || y >= tilemap->height) {
+    return;
+  }
+
+  uint8_t* tile = &tilemap->tiles[y * tilemap->width + x];
+  if (*tile == kind) {
+    return;
+  }
+
+  TilemapChunk* chunk = chunk_at(tilemap, x, y);
+  if (*tile == TILE_EMPTY) {
+    chunk->tile_count++;
+  } else if (kind == TILE_EMPTY) {
+    chunk->tile_count--;
+  }
+
+  chunk->dirty = true;
+  *tile        = (uint8_t)kind;
+}
+
+// =============================================================================
+// Rendering
+// =============================================================================
+
+void tilemap_bake(Tilemap* tilemap, CF_Aabb camera) {
+  tilemap->baked_chunks = 0;
+
+  int x0, y0, x1, y1;
+  if (!chunk_range(tilemap, camera, &x0, &y0, &x1, &y1)) {
+    return;
+  }
+
+  for (int cy = y0; cy <= y1; cy++) {
+    for (int cx = x0; cx <= x1; cx++) {
+      const TilemapChunk* chunk = &tilemap->chunks[cy * tilemap->chunks_x + cx];
+      if (!chunk->dirty || chunk->tile_count == 0) {
+        continue;
+      }
+
+      // Transparent where there are no tiles; set up once for the first bake
+      if (tilemap->baked_chunks++ == 0) {
+        cf_clear_color(0.0f, 0.0f, 0.0f, 0.0f);
+        cf_draw_projection(
+            cf_ortho_2d(0, 0, TILEMAP_CHUNK_SIZE, TILEMAP_CHUNK_SIZE));
+      }
+      bake_chunk(tilemap, cx, cy);
+    }
+  }
+
+  if (tilemap->baked_chunks > 0) {
+    cf_draw_projection(cf_ortho_2d(0, 0, CANVAS_WIDTH, CANVAS_HEIGHT));
+  }
+}
+
+void tilemap_draw(Tilemap* tilemap, CF_Aabb camera) {
+  tilemap->visible_chunks = 0;
+
+  int x0, y0, x1, y1;
+  if (!chunk_range(tilemap, camera, &x0, &y0, &x1, &y1)) {
+    return;
+  }
+
+  CF_V2 size = cf_v2(TILEMAP_CHUNK_SIZE, TILEMAP_CHUNK_SIZE);
+
+  for (int cy = y0; cy <= y1; cy++) {
+    for (int cx = x0; cx <= x1; cx++) {
+      const TilemapChunk* chunk = &tilemap->chunks[cy * tilemap->chunks_x + cx];
+      // Never baked, or emptied since (bake skips those, so they stay dirty)
+      if (!chunk->has_canvas || chunk->dirty) {
+        continue;
+      }
+
+      cf_draw_canvas(chunk->canvas, chunk_center(tilemap, cx, cy), size);
+      tilemap->visible_chunks++;
+    }
+  }
+}
@@ -0,0 +1,68 @@
+// tilemap.h - Chunked static level geometry
+//
+// Levels are grids of tiles grouped into square chunks. Each chunk's tiles
+// are baked once into a canvas of their own, so a frame costs one textured
+// quad per visible chunk instead of one draw per tile, and tiles never pass
+// through the ECS or sys_record_sprites. Chunks are baked lazily when they
+// first come into view and again only after a tile in them changes.
+//
+// Level files are text, one character per tile, top row first:
+//
+//   '#' ground   '=' platform   'X' crate   anything else is empty
+
+#pragma once
+
+#include <cute_graphics.h>
+#include <cute_math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TILEMAP_TILE_SIZE 16
+#define TILEMAP_CHUNK_TILES 16 // Chunk edge, in tiles
+#define TILEMAP_CHUNK_SIZE (TILEMAP_TILE_SIZE * TILEMAP_CHUNK_TILES)
+
+typedef enum TileKind {
+  TILE_EMPTY,
+  TILE_GROUND,
+  TILE_PLATFORM,
+  TILE_CRATE,
+  TILE_KIND_COUNT
+} TileKind;
+
+typedef struct TilemapChunk {
+  CF_Canvas canvas; // Created on first bake
+  bool has_canvas;
+  bool dirty;          // Tiles changed since the last bake
+  uint32_t tile_count; // Non-empty tiles; empty chunks are never baked
+} TilemapChunk;
+
+typedef struct Tilemap {
+  uint8_t* tiles; // TileKind per tile, row 0 at the bottom
+  int width;
+  int height;
+  CF_V2 origin; // World position of the bottom-left corner
+
+  TilemapChunk* chunks; // Row-major, chunks_x * chunks_y
+  int chunks_x;
+  int chunks_y;
+
+  // Last frame, for the debug overlay
+  int visible_chunks;
+  int baked_chunks;
+} Tilemap;
+
+// Replaces `tilemap` with the level at `path`. Returns false (leaving the map
+// empty) if the file cannot be read.
+bool tilemap_load(Tilemap* tilemap, const char* path, CF_V2 origin);
+void tilemap_free(Tilemap* tilemap);
+
+// Out-of-range tiles are empty; setting them does nothing.
+TileKind tilemap_get(const Tilemap* tilemap, int x, int y);
+void tilemap_set(Tilemap* tilemap, int x, int y, TileKind kind);
+
+// Renders dirty chunks inside `camera` into their canvases. Rendering to a
+// canvas flushes every queued draw, so call this before drawing the frame.
+void tilemap_bake(Tilemap* tilemap, CF_Aabb camera);
+
+// Draws the baked chunks inside `camera`.
+void tilemap_draw(Tilemap* tilemap, CF_Aabb camera);
@@ -5,147 +5,548 @@
 
 #define PICO_ECS_IMPLEMENTATION
 
+// Route ECS storage through the world's pool (mem_ctx). Its blocks come from
+// the CF allocator, so the memory tracker (engine/memory.h) sees them.
+#include "ecs_pool.h"
+#define PICO_ECS_MALLOC(size, ctx) (ecs_pool_alloc(ctx, size))
+#define PICO_ECS_REALLOC(ptr, size, ctx) (ecs_pool_realloc(ctx, ptr, size))
+#define PICO_ECS_FREE(ptr, ctx) (ecs_pool_release(ctx, ptr))
+
 #include "world.h"
 
-#include <cute_coroutine.h>
-#include <cute_map.h>
+#include <cute_c_runtime.h>
 #include <cute_math.h>
 #include <cute_sprite.h>
+#include <string.h>
 
+#include "../config/config.h"
+#include "../engine/arena.h"
 #include "../engine/game_state.h"
+#include "../engine/log.h"
+#include "../engine/memory.h"
+#include "../engine/platform.h"
 #include "systems/systems.h"
 
+WorldHandles world_handles;
+
 // =============================================================================
 // Player Factory
 // =============================================================================
 
 void make_player(void) {
-  // Create player entity and store in world
-  ecs_entity_t player = ecs_create(state->world.ecs);
+  // Create player entity and store in world. Input, transform (center of
+  // screen, CF origin is at center) and velocity start zeroed.
+  ecs_entity_t player = ECS_SPAWN(A_Player);
   state->world.player = player;
 
-  // Add components to player
-  ECS_ADD(player, C_PlayerInput);
-
   // Initialize player controller with default speeds
-  auto controller              = ECS_ADD(player, C_PlayerController);
+  auto controller              = ECS_GET(player, C_PlayerController);
   controller->walk_speed       = 150.0f;
   controller->facing_direction = cf_v2(1.0f, 0.0f); // Default: facing right
 
   // Initialize player state
-  auto ps     = ECS_ADD(player, C_PlayerState);
-  ps->current = PLAYER_STATE_IDLE;
-  ps->co.id   = 0; // Coroutine created on first tick
+  auto ps      = ECS_GET(player, C_PlayerState);
+  ps->current  = PLAYER_STATE_IDLE;
+  ps->behavior = (Behavior){.wait = BEHAVIOR_WAIT_NONE};
+
+  // Initialize sprite with player_combat.ase (gun animations). It streams in
+  // the background; the behaviour picks an animation once it is ready.
+  make_sprite(player, "assets/sprites/player_combat.ase", SPRITE_LAYER_ACTORS);
+
+  // Hurtbox: found by projectiles, looks for nothing itself
+  auto collider          = ECS_ADD(player, C_Collider);
+  collider->shape        = COLLIDER_AABB;
+  collider->half_extents = cf_v2(8.0f, 16.0f);
+  collider->layer        = COLLISION_LAYER_PLAYER;
+}
 
-  // Initialize transform at center of screen (CF origin is at center)
-  auto transform      = ECS_ADD(player, C_Transform);
-  transform->position = cf_v2(0.0f, 0.0f);
-  transform->rotation = 0.0f;
+// =============================================================================
+// Kinematic Bodies
+// =============================================================================
+// Moves an entity's position/velocity into the SoA body arrays. Entities that
+// also have a C_Transform get it written back after integration. A_Body
+// entities already carry C_Body and must be passed here right after spawning.
 
-  // Initialize velocity (stationary)
-  auto velocity = ECS_ADD(player, C_Velocity);
-  *velocity     = cf_v2(0.0f, 0.0f);
+void make_body(ecs_entity_t entity, CF_V2 position, CF_V2 velocity) {
+  size_t row = bodies_add(&state->world.bodies, entity, position, velocity);
 
-  // Initialize sprite with player_combat.ase (gun animations)
-  auto sprite = ECS_ADD(player, C_Sprite);
-  *sprite     = cf_make_sprite("assets/sprites/player_combat.ase");
+  auto body = ecs_has(state->world.ecs, entity, ECS_GET_COMP(C_Body))
+                  ? ECS_GET(entity, C_Body)
+                  : ECS_ADD(entity, C_Body);
+  body->row = row;
+}
 
-  // Start with walk animation
-  cf_sprite_play(sprite, "GunWalk");
+// Releases the body row and patches the entity swapped into its place. Uses a
+// view rather than ECS_GET since the moved entity may be queued for
+// destruction.
+static void destroy_body([[maybe_unused]] ecs_t* ecs,
+                         [[maybe_unused]] ecs_entity_t entity,
+                         void* comp_ptr) {
+  C_Body* body       = comp_ptr;
+  ecs_entity_t moved = bodies_remove(&state->world.bodies, body->row);
+
+  if (!ecs_is_invalid_entity(moved)) {
+    ecs_view_t bodies = ECS_VIEW(C_Body);
+    ECS_ROW(bodies, C_Body, moved)->row = body->row;
+  }
 }
 
 // =============================================================================
-// World Initialization
+// Sprites
 // =============================================================================
+// Sprite data is shared through the asset cache; each entity gets its own
+// playback instance. Sprites that are still loading start on the placeholder
+// and are tagged C_SpriteLoading until sys_resolve_sprites swaps them. Clip
+// tables are resolved as soon as the asset is ready. Sprite entities get a
+// C_Lod, so their animation and behaviour slow down away from the camera.
+
+C_Sprite* make_sprite(ecs_entity_t entity, const char* path,
+                      SpriteLayer layer) {
+  auto sprite    = ECS_ADD(entity, C_Sprite);
+  sprite->asset  = asset_acquire_sprite(&state->assets, path);
+  sprite->sprite = asset_sprite(&state->assets, sprite->asset);
+  sprite->layer  = layer;
+  sprite->clip   = ANIM_CLIP_NONE;
+
+  if (asset_is_ready(&state->assets, sprite->asset)) {
+    animations_resolve(&state->world.animations, &state->assets,
+                       sprite->asset, &sprite->sprite);
+  } else if (!asset_is_settled(&state->assets, sprite->asset)) {
+    ECS_ADD(entity, C_SpriteLoading);
+  }
 
-// NOLINTBEGIN
-void init_world(void) {
-  // Create ECS context
-  state->world.ecs        = ecs_new(ECS_ENTITY_COUNT, nullptr);
-  state->world.components = nullptr;
-  state->world.systems    = nullptr;
-  state->world.dt         = 0.0f;
+  if (!ecs_has(state->world.ecs, entity, ECS_GET_COMP(C_Lod))) {
+    ECS_ADD(entity, C_Lod);
+  }
+
+  return sprite;
+}
+
+// Starts `clip` from its first frame. Like cf_sprite_play, a clip the sprite
+// doesn't have leaves it unchanged.
+void play_clip(C_Sprite* sprite, AnimClip clip) {
+  if (!asset_is_ready(&state->assets, sprite->asset)) {
+    return;
+  }
+
+  const AnimClipSet* set =
+      animations_resolve(&state->world.animations, &state->assets,
+                         sprite->asset, &sprite->sprite);
+  if (!set->clips[clip]) {
+    return;
+  }
+
+  CF_Sprite* s   = &sprite->sprite;
+  s->animation   = set->clips[clip];
+  s->frame_index = animation_first_frame(s->animation);
+  s->loop_count  = 0;
+  s->t           = 0.0f;
+  s->paused      = false;
+  sprite->clip   = clip;
+}
+
+static void destroy_sprite([[maybe_unused]] ecs_t* ecs,
+                           [[maybe_unused]] ecs_entity_t entity,
+                           void* comp_ptr) {
+  C_Sprite* sprite = comp_ptr;
+  asset_release_sprite(&state->assets, sprite->asset);
+}
+
+// =============================================================================
+// Component Layouts
+// =============================================================================
+
+static ComponentLayout* find_layout(const char* name) {
+  for (size_t i = 0; i < state->world.layout_count; i++) {
+    if (strcmp(state->world.layouts[i].name, name) == 0) {
+      return &state->world.layouts[i];
+    }
+  }
+  return nullptr;
+}
+
+static bool layout_matches(const ComponentLayout* layout,
+                           const ComponentDesc* desc) {
+  return layout->size == desc->size && layout->align == desc->align &&
+         layout->version == desc->version;
+}
+
+typedef struct ComponentMigration {
+  ComponentMigrateFn migrate;
+  uint32_t old_version;
+} ComponentMigration;
+
+static void migrate_instance(const void* old_comp, void* new_comp,
+                             void* udata) {
+  const ComponentMigration* migration = udata;
+  migration->migrate(old_comp, migration->old_version, new_comp);
+}
+
+ecs_comp_t world_define_component(const ComponentDesc* desc) {
+  CF_ASSERT(strlen(desc->name) < WORLD_COMPONENT_NAME_SIZE);
+
+  ecs_t* ecs              = state->world.ecs;
+  ComponentLayout* layout = find_layout(desc->name);
+
+  if (!layout) {
+    CF_ASSERT(state->world.layout_count < WORLD_MAX_COMPONENTS);
+
+    ecs_comp_t comp = ecs_define_component_ex(ecs, desc->size, desc->ctor,
+                                              desc->dtor, desc->storage);
+    CF_ASSERT(comp.id == state->world.layout_count);
+
+    layout = &state->world.layouts[state->world.layout_count++];
+    *layout = (ComponentLayout){
+        .size    = desc->size,
+        .align   = desc->align,
+        .storage = desc->storage,
+        .version = desc->version,
+        .comp    = comp,
+    };
+    strcpy(layout->name, desc->name);
+  } else {
+    if (!layout_matches(layout, desc)) {
+      log_info("world", "Migrating %s: v%u (%zu bytes) -> v%u (%zu bytes)",
+               desc->name, layout->version, layout->size, desc->version,
+               desc->size);
+
+      ComponentMigration migration = {
+          .migrate     = desc->migrate,
+          .old_version = layout->version,
+      };
+      ecs_migrate_component(ecs, layout->comp, desc->size,
+                            desc->migrate ? migrate_instance : nullptr,
+                            &migration);
+
+      layout->size    = desc->size;
+      layout->align   = desc->align;
+      layout->version = desc->version;
+    }
+
+    // Living rows can't change storage mode in place
+    if (layout->storage != desc->storage) {
+      log_warn("world", "%s changed storage mode, restart to apply it",
+               desc->name);
+    }
+
+    // Callbacks point into the previous library
+    ecs_set_component_callbacks(ecs, layout->comp, desc->ctor, desc->dtor);
+  }
+
+  layout->registered = true;
+  return layout->comp;
+}
+
+// =============================================================================
+// Registration
+// =============================================================================
+// Shared by init_world and world_hot_reload, so a reloaded library registers
+// exactly what a fresh start would: added systems are scheduled and changed
+// access declarations take effect without a restart.
 
-  // Register components
+// NOLINTBEGIN
+static void register_components(void) {
+  // Player-only and sprite data is packed
   ECS_REGISTER_COMP(C_PlayerInput);
-  ECS_REGISTER_COMP(C_PlayerController);
+  ECS_REGISTER_COMP_PACKED(C_PlayerController);
   ECS_REGISTER_COMP(C_PlayerState);
   ECS_REGISTER_COMP(C_Transform);
   ECS_REGISTER_COMP(C_Velocity);
-  ECS_REGISTER_COMP(C_Sprite);
+  ECS_REGISTER_COMP_EX(C_Sprite, nullptr, destroy_sprite, ECS_STORAGE_PACKED);
+  ECS_REGISTER_COMP_PACKED(C_SpriteLoading);
+  ECS_REGISTER_COMP_CB(C_Body, nullptr, destroy_body);
+  ECS_REGISTER_COMP(C_Collider);
+  ECS_REGISTER_COMP_PACKED(C_Lod);
+}
 
-  // Register systems
-  ECS_REGISTER_SYSTEM(sys_gather_input, nullptr);
-  ECS_REQUIRE_COMP(sys_gather_input, C_PlayerInput);
+static void register_archetypes(void) {
+  // Sprites are added by make_sprite
+  ECS_REGISTER_ARCHETYPE(A_Player, ECS_GET_COMP(C_PlayerInput),
+                         ECS_GET_COMP(C_PlayerController),
+                         ECS_GET_COMP(C_PlayerState),
+                         ECS_GET_COMP(C_Transform), ECS_GET_COMP(C_Velocity));
+  ECS_REGISTER_ARCHETYPE(A_Mover, ECS_GET_COMP(C_Transform),
+                         ECS_GET_COMP(C_Velocity));
+  ECS_REGISTER_ARCHETYPE(A_Body, ECS_GET_COMP(C_Transform),
+                         ECS_GET_COMP(C_Body));
+  // Projectiles are SoA bodies (make_body); targets move with C_Velocity
+  ECS_REGISTER_ARCHETYPE(A_Projectile, ECS_GET_COMP(C_Transform),
+                         ECS_GET_COMP(C_Body), ECS_GET_COMP(C_Collider));
+  ECS_REGISTER_ARCHETYPE(A_Target, ECS_GET_COMP(C_Transform),
+                         ECS_GET_COMP(C_Velocity), ECS_GET_COMP(C_Collider));
+}
+
+static void register_systems(void) {
+  // Systems with their component access
+  ECS_REGISTER_SYSTEM(sys_snapshot_transforms, nullptr);
+  ECS_WRITE_COMP(sys_snapshot_transforms, C_Transform);
+  ECS_PARALLEL(sys_snapshot_transforms, 1024);
+
+  ECS_REGISTER_SYSTEM(sys_update_lod, nullptr);
+  ECS_WRITE_COMP(sys_update_lod, C_Lod);
+  ECS_READ_COMP(sys_update_lod, C_Transform);
+  ECS_PARALLEL(sys_update_lod, 1024);
+
+  ECS_REGISTER_SYSTEM(sys_resolve_sprites, nullptr);
+  ECS_WRITE_COMP(sys_resolve_sprites, C_Sprite);
+  ECS_WRITE_COMP(sys_resolve_sprites, C_SpriteLoading);
+  ECS_MAIN_THREAD(sys_resolve_sprites); // Reads the asset cache
+
+  // One pass over every sprite; finished clips go to a tick arena queue
+  ECS_REGISTER_SYSTEM(sys_advance_animations, nullptr);
+  ECS_WRITE_COMP(sys_advance_animations, C_Sprite);
+  ECS_READ_COMP(sys_advance_animations, C_Lod);
+  ECS_EXCLUDE_COMP(sys_advance_animations, C_SpriteLoading);
+  ECS_MAIN_THREAD(sys_advance_animations);
+  ECS_PHASE(sys_advance_animations, WORLD_PHASE_ANIMATION);
 
-  ECS_REGISTER_SYSTEM(sys_player_coroutine, nullptr);
-  ECS_REQUIRE_COMP(sys_player_coroutine, C_PlayerState);
+  ECS_REGISTER_SYSTEM(sys_gather_input, nullptr);
+  ECS_WRITE_COMP(sys_gather_input, C_PlayerInput);
+  ECS_MAIN_THREAD(sys_gather_input);
+  ECS_PHASE(sys_gather_input, WORLD_PHASE_INPUT);
+
+  ECS_REGISTER_SYSTEM(sys_player_behavior, nullptr);
+  ECS_WRITE_COMP(sys_player_behavior, C_PlayerState);
+  ECS_WRITE_COMP(sys_player_behavior, C_PlayerController);
+  ECS_WRITE_COMP(sys_player_behavior, C_Sprite);
+  ECS_READ_COMP(sys_player_behavior, C_PlayerInput);
+  ECS_READ_COMP(sys_player_behavior, C_Velocity);
+  ECS_READ_COMP(sys_player_behavior, C_Lod);
+  ECS_EXCLUDE_COMP(sys_player_behavior, C_SpriteLoading);
+  ECS_MAIN_THREAD(sys_player_behavior); // Consumes the animation events
+  ECS_PHASE(sys_player_behavior, WORLD_PHASE_BEHAVIOR);
 
   ECS_REGISTER_SYSTEM(sys_update_player_movement, nullptr);
-  ECS_REQUIRE_COMP(sys_update_player_movement, C_Velocity);
-  ECS_REQUIRE_COMP(sys_update_player_movement, C_PlayerController);
-  ECS_REQUIRE_COMP(sys_update_player_movement, C_PlayerState);
-  ECS_REQUIRE_COMP(sys_update_player_movement, C_PlayerInput);
+  ECS_WRITE_COMP(sys_update_player_movement, C_Velocity);
+  ECS_READ_COMP(sys_update_player_movement, C_PlayerController);
+  ECS_READ_COMP(sys_update_player_movement, C_PlayerState);
+  ECS_READ_COMP(sys_update_player_movement, C_PlayerInput);
+  ECS_PARALLEL(sys_update_player_movement, 256);
+  ECS_PHASE(sys_update_player_movement, WORLD_PHASE_BEHAVIOR);
 
   ECS_REGISTER_SYSTEM(sys_apply_velocity, nullptr);
-  ECS_REQUIRE_COMP(sys_apply_velocity, C_Transform);
-  ECS_REQUIRE_COMP(sys_apply_velocity, C_Velocity);
+  ECS_WRITE_COMP(sys_apply_velocity, C_Transform);
+  ECS_READ_COMP(sys_apply_velocity, C_Velocity);
+  ECS_PARALLEL(sys_apply_velocity, 1024);
+  ECS_PHASE(sys_apply_velocity, WORLD_PHASE_PHYSICS);
+
+  // Integrates the whole SoA store in one call, so it runs as a single task
+  ECS_REGISTER_SYSTEM(sys_integrate_bodies, nullptr);
+  ECS_WRITE_COMP(sys_integrate_bodies, C_Body);
+  ECS_PHASE(sys_integrate_bodies, WORLD_PHASE_PHYSICS);
+
+  ECS_REGISTER_SYSTEM(sys_sync_body_transforms, nullptr);
+  ECS_READ_COMP(sys_sync_body_transforms, C_Body);
+  ECS_WRITE_COMP(sys_sync_body_transforms, C_Transform);
+  ECS_PARALLEL(sys_sync_body_transforms, 1024);
+  ECS_PHASE(sys_sync_body_transforms, WORLD_PHASE_PHYSICS);
+
+  // Run after the schedule, not in it, so the grid is also cleared when no
+  // entities remain
+  ECS_REGISTER_SYSTEM(sys_index_spatial, nullptr);
+  ECS_REQUIRE_COMP(sys_index_spatial, C_Transform);
+
+  // Same, and on the main thread: contacts go to the tick arena
+  ECS_REGISTER_SYSTEM(sys_detect_collisions, nullptr);
+  ECS_REQUIRE_COMP(sys_detect_collisions, C_Collider);
+  ECS_REQUIRE_COMP(sys_detect_collisions, C_Transform);
+
+  // Called by the recording job with a list of visible entities
+  ECS_REGISTER_SYSTEM(sys_record_sprites, nullptr);
+  ECS_REQUIRE_COMP(sys_record_sprites, C_Sprite);
+  ECS_REQUIRE_COMP(sys_record_sprites, C_Transform);
+
+  // Update order; the schedule runs non-conflicting systems side by side
+  ECS_SCHEDULE(sys_snapshot_transforms);
+  ECS_SCHEDULE(sys_update_lod);
+  ECS_SCHEDULE(sys_resolve_sprites);
+  ECS_SCHEDULE(sys_advance_animations);
+  ECS_SCHEDULE(sys_gather_input);
+  ECS_SCHEDULE(sys_player_behavior);
+  ECS_SCHEDULE(sys_update_player_movement);
+  ECS_SCHEDULE(sys_apply_velocity);
+  ECS_SCHEDULE(sys_integrate_bodies);
+  ECS_SCHEDULE(sys_sync_body_transforms);
+}
+// NOLINTEND
 
-  ECS_REGISTER_SYSTEM(sys_render_sprites, nullptr);
-  ECS_REQUIRE_COMP(sys_render_sprites, C_Sprite);
-  ECS_REQUIRE_COMP(sys_render_sprites, C_Transform);
+// =============================================================================
+// World Initialization
+// =============================================================================
 
-  // Create player using factory function
-  make_player();
+void init_world(void) {
+  MemoryTag tag = memory_set_tag(MEMORY_TAG_WORLD);
+
+  // Create ECS context, with storage for ECS_ENTITY_COUNT reserved up front
+  Platform* platform = state->platform;
+  size_t page_size   = platform && platform->get_system_page_size
+                           ? (size_t)platform->get_system_page_size()
+                           : 4096;
+  ecs_pool_init(&state->world.ecs_pool, page_size, ECS_POOL_RESERVE);
+  state->world.ecs    = ecs_new(ECS_ENTITY_COUNT, &state->world.ecs_pool);
+  state->world.dt     = 0.0f;
+  state->world.tick   = 0;
+  state->world.phases = WORLD_PHASE_ALL;
+  bodies_init(&state->world.bodies, ECS_ENTITY_COUNT);
+  schedule_init(&state->world.schedule, state->platform);
+  spatial_init(&state->world.spatial, SPATIAL_CELL_SIZE, SPATIAL_BUCKET_COUNT);
+  collisions_init(&state->world.collisions);
+  arena_init(&state->world.tick_arena, "tick", TICK_ARENA_SIZE);
+
+  // Camera covers the canvas (CF origin is at center)
+  CF_V2 half_canvas   = cf_v2(CANVAS_WIDTH * 0.5f, CANVAS_HEIGHT * 0.5f);
+  state->world.camera = cf_make_aabb(cf_neg(half_canvas), half_canvas);
+
+  register_components();
+  register_archetypes();
+  register_systems();
+
+  memory_set_tag(tag);
 }
-// NOLINTEND
 
 // =============================================================================
 // Main Update Function
 // =============================================================================
-// Runs systems in explicit order for control over execution pipeline.
+// Runs the scheduled systems of the enabled phases. Stages follow the
+// ECS_SCHEDULE order; systems within a stage touch disjoint components and run
+// on the worker pool.
 
 void update_world(float dt) {
+  MemoryTag tag   = memory_set_tag(MEMORY_TAG_WORLD);
   state->world.dt = dt;
+  state->world.tick++;
+
+  // One input sample per tick, recorded or replaced by a replay
+  state->world.input_bits =
+      input_replay_tick(&state->world.replay, read_input_bits());
+
+  // Last tick's contacts and finished clips. Refilled by sys_detect_collisions
+  // and sys_advance_animations, which doesn't run without sprites.
+  arena_reset(&state->world.tick_arena);
+  state->world.collisions.contacts = (Contacts){0};
+  state->world.animations.finished = (AnimEvents){0};
+
+  // Counted by sys_update_lod
+  for (int i = 0; i < LOD_LEVEL_COUNT; i++) {
+    cf_atomic_set(&state->world.lod.entities[i], 0);
+  }
+  cf_atomic_set(&state->world.lod.due, 0);
+
+  // sys_advance_animations reads every sprite each tick; keep the rows in its
+  // entity order. Once sorted, only rows moved by spawns and removals swap.
+  ECS_PACK_COMP(C_Sprite, sys_advance_animations);
+
+  schedule_run(&state->world.schedule, state->world.ecs, state->world.phases);
+
+  // Spatial index and contacts see the final transforms of this update
+  ECS_RUN_SYSTEM(sys_index_spatial);
+  ECS_RUN_SYSTEM(sys_detect_collisions);
 
-  // Input
-  ECS_RUN_SYSTEM(sys_gather_input);
+  memory_set_tag(tag);
+}
+
+// =============================================================================
+// Draw Recording
+// =============================================================================
+// After each tick, a job records the sprites inside the camera rect into the
+// back draw list (draw_list.h). The spatial index supplies the visible
+// entities, which are handed straight to the record system instead of
+// iterating every sprite. The job only reads the world, so it runs until the
+// next tick or render_world needs the list.
+
+static void record_world_job(void* udata) {
+  DrawList* list          = udata;
+  const SpatialGrid* grid = &state->world.spatial;
+
+  ProfileZone zone = profiler_begin("record_world");
+
+  size_t count = spatial_query(grid, state->world.camera, list->entities,
+                               list->capacity);
+
+  // Keep entities that have a sprite (transform is implied by the index)
+  size_t sprite_count = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (ecs_has(state->world.ecs, list->entities[i], ECS_GET_COMP(C_Sprite))) {
+      list->entities[sprite_count++] = list->entities[i];
+    }
+  }
 
-  // Logic - coroutine drives state and animation
-  ECS_RUN_SYSTEM(sys_player_coroutine);
-  ECS_RUN_SYSTEM(sys_update_player_movement);
+  PROFILE_ZONE("sys_record_sprites",
+               sys_record_sprites(state->world.ecs, list->entities,
+                                  sprite_count, list));
+  profiler_end(zone);
+}
+
+void record_world(void) {
+  // The index holds every entity a query can return
+  draw_lists_record(&state->world.draw, state->platform,
+                    state->world.spatial.count, record_world_job);
+}
 
-  // Physics
-  ECS_RUN_SYSTEM(sys_apply_velocity);
+void finish_record_world(void) {
+  PROFILE_ZONE("finish_record_world",
+               draw_lists_finish(&state->world.draw, state->platform));
 }
 
 // =============================================================================
 // Render World
 // =============================================================================
-// Renders all sprites using the render system.
+// Renders the level chunks, then replays the sprites of the last recording at
+// this frame's alpha.
 
-void render_world(void) { ECS_RUN_SYSTEM(sys_render_sprites); }
+void render_world(void) {
+  finish_record_world();
+
+  PROFILE_ZONE("tilemap_draw",
+               tilemap_draw(&state->world.tilemap, state->world.camera));
+  PROFILE_ZONE("draw_lists_replay",
+               draw_lists_replay(&state->world.draw, state->world.alpha));
+}
 
 // =============================================================================
 // Hot Reload
 // =============================================================================
-// Updates system callbacks after the game library is reloaded.
-// Function pointers become stale when the library is unloaded/reloaded.
+// Entities and component data stay in GameState (behaviour and sprite
+// playback are plain data). Everything that points into the old library -
+// callbacks, system definitions, schedule names - is registered again from
+// this library's tables, and components are matched by name to their
+// recorded layouts.
 
 void world_hot_reload(void) {
-  // Destroy stale coroutine (saved context points to old code segment)
-  auto ps = ECS_GET(state->world.player, C_PlayerState);
-  if (ps->co.id != 0) {
-    cf_destroy_coroutine(ps->co);
-    ps->co.id = 0; // Will be recreated on next tick
+  ecs_t* ecs = state->world.ecs;
+
+  for (size_t i = 0; i < state->world.layout_count; i++) {
+    state->world.layouts[i].registered = false;
+  }
+  register_components();
+
+  // Components this library no longer has keep their data, but must not call
+  // back into the unloaded one
+  for (size_t i = 0; i < state->world.layout_count; i++) {
+    const ComponentLayout* layout = &state->world.layouts[i];
+    if (!layout->registered) {
+      log_warn("world", "%s is no longer registered", layout->name);
+      ecs_set_component_callbacks(ecs, layout->comp, nullptr, nullptr);
+    }
   }
 
-  // Update system callbacks
-  ECS_UPDATE_SYSTEM(sys_gather_input, nullptr);
-  ECS_UPDATE_SYSTEM(sys_player_coroutine, nullptr);
-  ECS_UPDATE_SYSTEM(sys_update_player_movement, nullptr);
-  ECS_UPDATE_SYSTEM(sys_apply_velocity, nullptr);
-  ECS_UPDATE_SYSTEM(sys_render_sprites, nullptr);
+  ecs_clear_archetypes(ecs);
+  register_archetypes();
+
+  // A string literal of the previous library
+  state->world.tick_arena.name = "tick";
+
+  // Clip tables follow this library's ANIM_CLIPS
+  animations_invalidate(&state->world.animations);
+
+  // Recorded ticks have the previous layouts; the quicksave is refused on load
+  // if they changed
+  snapshot_history_clear(&state->world.history);
+
+  ecs_clear_systems(ecs);
+  schedule_init(&state->world.schedule, state->platform);
+  register_systems();
+  ecs_sync_systems(ecs);
 }
 
 // =============================================================================
@@ -153,22 +554,23 @@ void world_hot_reload(void) {
 // =============================================================================
 
 void shutdown_world(void) {
-  // Destroy coroutine before freeing ECS
-  auto ps = ECS_GET(state->world.player, C_PlayerState);
-  if (ps->co.id != 0) {
-    cf_destroy_coroutine(ps->co);
-  }
+  // The job reads the world freed below
+  draw_lists_free(&state->world.draw, state->platform);
 
   if (state->world.ecs) {
     ecs_free(state->world.ecs);
     state->world.ecs = nullptr;
   }
 
-  if (state->world.components) {
-    cf_map_free(state->world.components);
-  }
-
-  if (state->world.systems) {
-    cf_map_free(state->world.systems);
-  }
+  ecs_pool_free(&state->world.ecs_pool);
+
+  bodies_free(&state->world.bodies);
+  spatial_free(&state->world.spatial);
+  collisions_free(&state->world.collisions);
+  arena_free(&state->world.tick_arena);
+  tilemap_free(&state->world.tilemap);
+  animations_free(&state->world.animations);
+  snapshot_free(&state->world.quicksave);
+  snapshot_history_free(&state->world.history);
+  schedule_free(&state->world.schedule);
 }
@@ -6,13 +6,27 @@
 
 #include <cute.h>
 #include <cute_array.h>
-#include <cute_coroutine.h>
-#include <cute_map.h>
 #include <cute_math.h>
 #include <cute_sprite.h>
-#include <cute_string.h>
 #include <pico_ecs.h>
+#include <stdalign.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../engine/asset.h"
+#include "../engine/profiler.h"
+#include "animation.h"
+#include "behavior.h"
+#include "bodies.h"
+#include "collision.h"
+#include "draw_list.h"
+#include "ecs_pool.h"
+#include "replay.h"
+#include "schedule.h"
+#include "snapshot.h"
+#include "spatial.h"
+#include "tilemap.h"
 
 // =============================================================================
 // ECS Macros
@@ -22,41 +36,82 @@
 #define ECS_ENTITY_COUNT 4096
 #endif
 
-#define ECS_GET_COMP(COMP)                                                     \
-  cf_map_get(state->world.components, cf_sintern(#COMP))
+// Initial ECS pool block: entity table, queues, component arrays and system
+// sets for ECS_ENTITY_COUNT entities, with room for size-class rounding
+#define ECS_POOL_RESERVE (ECS_ENTITY_COUNT * 512)
+
+// Component, system and archetype registries. Each entry becomes a handle
+// field in ComponentIds/SystemIds/ArchetypeIds, resolved in init_world (and
+// again in world_hot_reload) so hot-path lookups are a plain struct load
+// instead of a string intern plus map lookup.
+#define WORLD_COMPONENTS(X)                                                    \
+  X(C_PlayerInput)                                                             \
+  X(C_PlayerController)                                                        \
+  X(C_PlayerState)                                                             \
+  X(C_Transform)                                                               \
+  X(C_Velocity)                                                                \
+  X(C_Sprite)                                                                  \
+  X(C_SpriteLoading)                                                           \
+  X(C_Body)                                                                    \
+  X(C_Collider)                                                                \
+  X(C_Lod)
+
+#define WORLD_SYSTEMS(X)                                                       \
+  X(sys_snapshot_transforms)                                                   \
+  X(sys_update_lod)                                                            \
+  X(sys_resolve_sprites)                                                       \
+  X(sys_advance_animations)                                                    \
+  X(sys_gather_input)                                                          \
+  X(sys_player_behavior)                                                       \
+  X(sys_update_player_movement)                                                \
+  X(sys_apply_velocity)                                                        \
+  X(sys_integrate_bodies)                                                      \
+  X(sys_sync_body_transforms)                                                  \
+  X(sys_index_spatial)                                                         \
+  X(sys_detect_collisions)                                                     \
+  X(sys_record_sprites)
+
+// Component sets entities are spawned with (see ECS_REGISTER_ARCHETYPE)
+#define WORLD_ARCHETYPES(X)                                                    \
+  X(A_Player)                                                                  \
+  X(A_Mover)                                                                   \
+  X(A_Body)                                                                    \
+  X(A_Projectile)                                                              \
+  X(A_Target)
 
-#define ECS_GET_SYSTEM(SYSTEM)                                                 \
-  cf_map_get(state->world.systems, cf_sintern(#SYSTEM))
+#define ECS_GET_COMP(COMP) (world_handles.components.COMP)
 
-#define ECS_REGISTER_COMP(COMP)                                                \
-  do {                                                                         \
-    ecs_comp_t id = ecs_define_component(state->world.ecs, sizeof(COMP),       \
-                                         nullptr, nullptr);                    \
-    cf_map_set(state->world.components, cf_sintern(#COMP), id);                \
-  } while (0)
+#define ECS_GET_SYSTEM(SYSTEM) (world_handles.systems.SYSTEM)
+
+#define ECS_GET_ARCHETYPE(ARCHETYPE) (world_handles.archetypes.ARCHETYPE)
+
+// Registers COMP (see world_define_component). Optional designated
+// initializers set the other ComponentDesc fields, e.g.
+// ECS_REGISTER_COMP(C_Transform, .version = 2, .migrate = migrate_transform).
+#define ECS_REGISTER_COMP(COMP, ...)                                           \
+  ECS_GET_COMP(COMP) = world_define_component(&(ComponentDesc){               \
+      .name = #COMP, .size = sizeof(COMP), .align = alignof(COMP), __VA_ARGS__})
 
 #define ECS_REGISTER_COMP_CB(COMP, CTOR, DTOR)                                 \
-  do {                                                                         \
-    ecs_comp_t id =                                                            \
-        ecs_define_component(state->world.ecs, sizeof(COMP), CTOR, DTOR);      \
-    cf_map_set(state->world.components, cf_sintern(#COMP), id);                \
-  } while (0)
+  ECS_REGISTER_COMP(COMP, .ctor = CTOR, .dtor = DTOR)
+
+// Registers a component with an explicit storage mode. Use ECS_STORAGE_PACKED
+// for components only a fraction of entities carry (sprites, controllers) so
+// memory tracks live components instead of the highest entity ID.
+#define ECS_REGISTER_COMP_EX(COMP, CTOR, DTOR, STORAGE)                        \
+  ECS_REGISTER_COMP(COMP, .ctor = CTOR, .dtor = DTOR, .storage = STORAGE)
+
+#define ECS_REGISTER_COMP_PACKED(COMP)                                         \
+  ECS_REGISTER_COMP(COMP, .storage = ECS_STORAGE_PACKED)
 
 #define ECS_REGISTER_SYSTEM(SYSTEM, UDATA)                                     \
-  do {                                                                         \
-    ecs_system_t id = ecs_define_system(state->world.ecs, 0, SYSTEM, nullptr,  \
-                                        nullptr, UDATA);                       \
-    cf_map_set(state->world.systems, cf_sintern(#SYSTEM), id);                 \
-  } while (0)
+  ECS_GET_SYSTEM(SYSTEM) = ecs_define_system(state->world.ecs, 0, SYSTEM,      \
+                                             nullptr, nullptr, UDATA)
 
 #define ECS_REQUIRE_COMP(SYSTEM, COMP)                                         \
   ecs_require_component(state->world.ecs, ECS_GET_SYSTEM(SYSTEM),              \
                         ECS_GET_COMP(COMP))
 
-#define ECS_UPDATE_SYSTEM(SYSTEM, UDATA)                                       \
-  ecs_set_system_callbacks(state->world.ecs, ECS_GET_SYSTEM(SYSTEM), SYSTEM,   \
-                           nullptr, nullptr)
-
 #define ECS_EXCLUDE_COMP(SYSTEM, COMP)                                         \
   ecs_exclude_component(state->world.ecs, ECS_GET_SYSTEM(SYSTEM),              \
                         ECS_GET_COMP(COMP))
@@ -67,18 +122,229 @@
 #define ECS_ADD(ENTITY, COMP)                                                  \
   (COMP*)ecs_add(state->world.ecs, ENTITY, ECS_GET_COMP(COMP), nullptr)
 
+// Defines ARCHETYPE from component handles (ECS_GET_COMP). Spawning adds the
+// whole set with a single pass over the systems, instead of one per ECS_ADD.
+#define ECS_REGISTER_ARCHETYPE(ARCHETYPE, ...)                                 \
+  ECS_GET_ARCHETYPE(ARCHETYPE) = ecs_define_archetype(                         \
+      state->world.ecs, (ecs_comp_t[]){__VA_ARGS__},                           \
+      sizeof((ecs_comp_t[]){__VA_ARGS__}) / sizeof(ecs_comp_t))
+
+// Creates an entity with all of ARCHETYPE's components, zeroed
+#define ECS_SPAWN(ARCHETYPE)                                                   \
+  ecs_spawn(state->world.ecs, ECS_GET_ARCHETYPE(ARCHETYPE))
+
+// Creates COUNT entities of ARCHETYPE into the ENTITIES array
+#define ECS_SPAWN_N(ARCHETYPE, COUNT, ENTITIES)                                \
+  ecs_spawn_n(state->world.ecs, ECS_GET_ARCHETYPE(ARCHETYPE), COUNT, ENTITIES)
+
+// Puts SYSTEM in one of the WORLD_PHASES (its pico_ecs system mask)
+#define ECS_PHASE(SYSTEM, PHASE)                                               \
+  ecs_set_system_mask(state->world.ecs, ECS_GET_SYSTEM(SYSTEM),                \
+                      WORLD_PHASE_BIT(PHASE))
+
+// Runs SYSTEM inside a profiler zone of the same name
 #define ECS_RUN_SYSTEM(SYSTEM)                                                 \
-  ecs_run_system(state->world.ecs, ECS_GET_SYSTEM(SYSTEM), 0)
+  PROFILE_ZONE(#SYSTEM,                                                        \
+               ecs_run_system(state->world.ecs, ECS_GET_SYSTEM(SYSTEM), 0))
+
+// Scheduler access declarations. ECS_READ_COMP/ECS_WRITE_COMP require the
+// component and record the access; ECS_DECLARE_READ/ECS_DECLARE_WRITE only
+// record it, for components reached through ECS_GET on other entities.
+#define ECS_DECLARE_READ(SYSTEM, COMP)                                         \
+  schedule_read(&state->world.schedule, ECS_GET_SYSTEM(SYSTEM),                \
+                ECS_GET_COMP(COMP))
+
+#define ECS_DECLARE_WRITE(SYSTEM, COMP)                                        \
+  schedule_write(&state->world.schedule, ECS_GET_SYSTEM(SYSTEM),               \
+                 ECS_GET_COMP(COMP))
+
+#define ECS_READ_COMP(SYSTEM, COMP)                                            \
+  ECS_REQUIRE_COMP(SYSTEM, COMP);                                              \
+  ECS_DECLARE_READ(SYSTEM, COMP)
 
+#define ECS_WRITE_COMP(SYSTEM, COMP)                                           \
+  ECS_REQUIRE_COMP(SYSTEM, COMP);                                              \
+  ECS_DECLARE_WRITE(SYSTEM, COMP)
+
+#define ECS_MAIN_THREAD(SYSTEM)                                                \
+  schedule_main_thread(&state->world.schedule, ECS_GET_SYSTEM(SYSTEM))
+
+// Splits SYSTEM's entities into worker batches of at least MIN_BATCH.
+#define ECS_PARALLEL(SYSTEM, MIN_BATCH)                                        \
+  schedule_parallel(&state->world.schedule, ECS_GET_SYSTEM(SYSTEM), MIN_BATCH)
+
+// Appends SYSTEM to the update order. Declare its access first.
+#define ECS_SCHEDULE(SYSTEM)                                                   \
+  schedule_add(&state->world.schedule, ECS_GET_SYSTEM(SYSTEM), #SYSTEM)
+
+// Batched component access for system loops. ECS_VIEW resolves a component's
+// storage once per system call; ECS_ROW indexes it with a compile-time stride,
+// so entity loops avoid a checked ecs_get call per component per entity.
+#define ECS_VIEW(COMP) ecs_get_view(state->world.ecs, ECS_GET_COMP(COMP))
+
+#define ECS_ROW(VIEW, COMP, ENTITY)                                            \
+  ((COMP*)(VIEW).data + ecs_view_index(VIEW, ENTITY))
+
+// Reorders a packed component so its rows follow SYSTEM's entity order.
+#define ECS_PACK_COMP(COMP, SYSTEM)                                            \
+  ecs_pack_component(state->world.ecs, ECS_GET_COMP(COMP),                     \
+                     ECS_GET_SYSTEM(SYSTEM))
+
+// =============================================================================
+// Phases - system masks
 // =============================================================================
-// World - ECS context with component/system registries
+// Systems are grouped into phases through their pico_ecs masks, and
+// update_world runs only the phases enabled in World.phases (toggled from the
+// debug overlay). Systems left out of every phase - transform snapshots, LOD,
+// sprite resolution, spatial index and collisions - always run.
+
+#define WORLD_PHASES(X)                                                        \
+  X(WORLD_PHASE_INPUT, "input")                                                \
+  X(WORLD_PHASE_BEHAVIOR, "behavior")                                          \
+  X(WORLD_PHASE_ANIMATION, "animation")                                        \
+  X(WORLD_PHASE_PHYSICS, "physics")
+
+#define WORLD_PHASE_ENUM(ID, NAME) ID,
+
+typedef enum WorldPhase {
+  WORLD_PHASES(WORLD_PHASE_ENUM) WORLD_PHASE_COUNT
+} WorldPhase;
+
+#undef WORLD_PHASE_ENUM
+
+#define WORLD_PHASE_BIT(PHASE) ((ecs_mask_t)1 << (PHASE))
+#define WORLD_PHASE_ALL (((ecs_mask_t)1 << WORLD_PHASE_COUNT) - 1)
+
+// =============================================================================
+// Level of Detail
+// =============================================================================
+// Behaviour and animation of entities away from the camera run at reduced
+// rates. sys_update_lod picks each C_Lod entity's level by its distance
+// outside the camera rect and marks it due every `interval` ticks, staggered
+// by entity ID so each tick takes an even share of the far entities. A due
+// entity catches up on the ticks it skipped. Movement, physics and collisions
+// stay at the full rate, so positions never depend on the camera.
+
+#define LOD_LEVELS(X)                                                          \
+  X(LOD_LEVEL_VISIBLE, "visible", 1)                                           \
+  X(LOD_LEVEL_NEAR, "near", 4)                                                 \
+  X(LOD_LEVEL_FAR, "far", 16)
+
+#define LOD_LEVEL_ENUM(ID, NAME, INTERVAL) ID,
+
+typedef enum LodLevel { LOD_LEVELS(LOD_LEVEL_ENUM) LOD_LEVEL_COUNT } LodLevel;
+
+#undef LOD_LEVEL_ENUM
+
+#define LOD_VISIBLE_MARGIN 64.0f // Outside the camera, still visible level
+#define LOD_NEAR_DISTANCE 512.0f // Outside the camera, near level
+
+// Entities per level and due entities of the last update
+typedef struct LodStats {
+  CF_AtomicInt entities[LOD_LEVEL_COUNT];
+  CF_AtomicInt due;
+} LodStats;
+
+// =============================================================================
+// Handle Tables - generated from the registries above
+// =============================================================================
+
+#define ECS_COMP_HANDLE(COMP) ecs_comp_t COMP;
+#define ECS_SYSTEM_HANDLE(SYSTEM) ecs_system_t SYSTEM;
+#define ECS_ARCHETYPE_HANDLE(ARCHETYPE) ecs_archetype_t ARCHETYPE;
+
+typedef struct ComponentIds {
+  WORLD_COMPONENTS(ECS_COMP_HANDLE)
+} ComponentIds;
+
+typedef struct SystemIds {
+  WORLD_SYSTEMS(ECS_SYSTEM_HANDLE)
+} SystemIds;
+
+typedef struct ArchetypeIds {
+  WORLD_ARCHETYPES(ECS_ARCHETYPE_HANDLE)
+} ArchetypeIds;
+
+#undef ECS_COMP_HANDLE
+#undef ECS_SYSTEM_HANDLE
+#undef ECS_ARCHETYPE_HANDLE
+
+// Handles of the loaded game library. They live in the library rather than in
+// GameState, so registries can grow across a hot reload without moving the
+// persistent fields after them.
+typedef struct WorldHandles {
+  ComponentIds components;
+  SystemIds systems;
+  ArchetypeIds archetypes;
+} WorldHandles;
+
+extern WorldHandles world_handles;
+
+// =============================================================================
+// Component Layouts - versioned reload protocol
+// =============================================================================
+// Every registered component records its layout in World. On hot reload the
+// new library registers its components again: matching layouts only rebind
+// their callbacks, changed ones have their live instances migrated in place,
+// new ones are defined and ones the library dropped are detached. C can't see
+// field lists, so the layout is size, alignment and storage plus a version
+// to bump for changes that keep the size.
+
+#define WORLD_MAX_COMPONENTS 32 // PICO_ECS_MAX_COMPONENTS
+#define WORLD_COMPONENT_NAME_SIZE 32
+
+// Converts one instance from an older layout. `new_comp` is zeroed.
+typedef void (*ComponentMigrateFn)(const void* old_comp, uint32_t old_version,
+                                   void* new_comp);
+
+typedef struct ComponentDesc {
+  const char* name;
+  size_t size;
+  size_t align;
+  ecs_storage_t storage;
+  ecs_constructor_fn ctor;
+  ecs_destructor_fn dtor;
+  uint32_t version;           // Bump for layout changes that keep the size
+  ComponentMigrateFn migrate; // Without one, the common prefix is copied
+} ComponentDesc;
+
+typedef struct ComponentLayout {
+  char name[WORLD_COMPONENT_NAME_SIZE];
+  size_t size;
+  size_t align;
+  ecs_storage_t storage;
+  uint32_t version;
+  ecs_comp_t comp;
+  bool registered; // Seen in the current registration pass
+} ComponentLayout;
+
+// =============================================================================
+// World - ECS context and persistent world state
 // =============================================================================
 
 typedef struct World {
   ecs_t* ecs;
-  CF_MAP(ecs_comp_t) components;
-  CF_MAP(ecs_system_t) systems;
+  EcsPool ecs_pool; // mem_ctx of ecs: all ECS storage
+  ComponentLayout layouts[WORLD_MAX_COMPONENTS]; // Indexed by component ID
+  size_t layout_count;
+  Bodies bodies;         // SoA position/velocity for C_Body entities
+  Schedule schedule;     // Update systems, staged by component access
+  SpatialGrid spatial;   // C_Transform entities, rebuilt every update
+  Collisions collisions; // C_Collider proxies and this tick's contacts
+  Arena tick_arena;      // Contacts and finished clips, reset every tick
+  Tilemap tilemap;       // Static level geometry, drawn behind sprites
+  Animations animations; // Clip tables and this tick's finished clips
+  CF_Aabb camera;        // Visible world rect, for render culling and LOD
+  DrawLists draw;        // Sprites of the last tick, replayed by render_world
+  LodStats lod;
+  ecs_mask_t phases; // WORLD_PHASE_BIT of each phase update_world runs
+  uint32_t tick;     // update_world calls, staggers LOD updates
   float dt;
+  float alpha; // Render position between the last two ticks, 0..1
+  InputReplay replay; // Records or plays back input_bits
+  Snapshot quicksave;      // F5 saves, F9 loads
+  SnapshotHistory history; // Recent ticks, rewound while backspace is held
+  uint8_t input_bits; // This tick's player input (see read_input_bits)
   ecs_entity_t player;
 } World;
 
@@ -126,27 +392,76 @@ typedef struct C_PlayerController {
   CF_V2 facing_direction; // Normalized, (1,0) = right
 } C_PlayerController;
 
-// C_PlayerState - Coroutine-based state management
-// Tracks current player state for animation and behavior selection.
+// C_PlayerState - Stackless state management
+// Tracks current player state and any pending one-shot wait, so behaviour
+// resumes where it left off after a hot reload.
 typedef struct C_PlayerState {
   PlayerState current;
-  CF_Coroutine co;
+  Behavior behavior;
 } C_PlayerState;
 
 // C_Transform - Position and rotation
 // Stores entity position in world space.
+// `previous` is the position at the start of the last tick, so rendering can
+// interpolate between ticks. Transforms created since then have no snapshot
+// yet and are drawn at `position`.
 typedef struct C_Transform {
   CF_V2 position;
   float rotation;
+  CF_V2 previous;
+  bool has_previous;
 } C_Transform;
 
 // C_Velocity - Movement vector
 // Stores current velocity for physics integration.
 typedef CF_V2 C_Velocity;
 
+// Draw order buckets for C_Sprite; lower layers are drawn first
+typedef enum SpriteLayer {
+  SPRITE_LAYER_BACKGROUND,
+  SPRITE_LAYER_ACTORS,
+  SPRITE_LAYER_EFFECTS,
+} SpriteLayer;
+
 // C_Sprite - Sprite and animation component
-// Holds sprite data for rendering and animation.
-typedef CF_Sprite C_Sprite;
+// Per-entity playback state over shared cached sprite data. Added with
+// make_sprite; the cache reference is released when the component is removed.
+// Clips are started with play_clip and advanced by sys_advance_animations.
+typedef struct C_Sprite {
+  CF_Sprite sprite;  // Animation, frame, timer and flip for this entity
+  AssetHandle asset; // Cached frames and atlas
+  SpriteLayer layer;
+  AnimClip clip; // Playing clip, ANIM_CLIP_NONE before the first play_clip
+} C_Sprite;
+
+// C_SpriteLoading - Tag for sprites still showing the asset placeholder
+// Removed by sys_resolve_sprites once the cached sprite is ready. Animation
+// systems exclude it, since the placeholder has no animations to play.
+typedef struct C_SpriteLoading {
+  char unused; // pico_ecs components must have a size
+} C_SpriteLoading;
+
+// C_Collider - Collision shape relative to C_Transform
+// Proxies are rebuilt each tick by sys_detect_collisions. `layer` is one
+// CollisionLayer bit; contacts are generated against colliders whose layer is
+// in `mask`, so hurtboxes and targets that only get hit leave it zero.
+typedef struct C_Collider {
+  ColliderShape shape;
+  CF_V2 offset;       // From C_Transform.position
+  CF_V2 half_extents; // COLLIDER_AABB
+  float radius;       // COLLIDER_CIRCLE
+  uint32_t layer;
+  uint32_t mask;
+} C_Collider;
+
+// C_Lod - Update rate by distance from the camera (see LOD_LEVELS)
+// Added by make_sprite; behaviour and animation skip the entity unless `due`,
+// then advance it by `ticks` ticks.
+typedef struct C_Lod {
+  uint8_t level; // LodLevel
+  uint8_t ticks; // Since the last due tick, this one included
+  bool due;
+} C_Lod;
 
 // =============================================================================
 // Function Declarations
@@ -154,7 +469,18 @@ typedef CF_Sprite C_Sprite;
 
 void init_world(void);
 void world_hot_reload(void);
+
+// Defines a component, or on hot reload resolves the one registered under the
+// same name, rebinding its callbacks and migrating it if the layout changed.
+ecs_comp_t world_define_component(const ComponentDesc* desc);
+
 void update_world(float dt);
+void record_world(void);
+void finish_record_world(void);
 void render_world(void);
 void shutdown_world(void);
 void make_player(void);
+void make_body(ecs_entity_t entity, CF_V2 position, CF_V2 velocity);
+C_Sprite* make_sprite(ecs_entity_t entity, const char* path,
+                      SpriteLayer layer);
+void play_clip(C_Sprite* sprite, AnimClip clip);
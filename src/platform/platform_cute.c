@@ -12,9 +12,23 @@
 #include <cute_symbol.h>
 #include <cute_time.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef SDL_PLATFORM_WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "../engine/log.h"
+#include "../engine/memory.h"
 #include "config.h"
+#include "platform_jobs.h"
+#include "platform_watch.h"
 #if __has_include(<_abort.h>)
 #include <_abort.h>
 #elif __has_include(<stdlib.h>)
@@ -23,14 +37,19 @@
 
 #define MAX_PATH_LENGTH 1024
 
+static char assets_path[MAX_PATH_LENGTH] = {0}; // Mounted at /assets
+
+#ifdef ENGINE_HOT_RELOADING
 static char game_library_path[MAX_PATH_LENGTH] = {0};
-static SDL_PathInfo path_info;
+static bool game_library_watched               = false;
 
-#ifdef SDL_PLATFORM_WIN32
-static char game_library_copy_path[MAX_PATH_LENGTH] = {0};
+// Loaded instead of the build output: Windows locks a loaded DLL, and the
+// dynamic loaders return the already open library for a path they know
+static char game_library_copy_paths[2][MAX_PATH_LENGTH] = {0};
 #endif
 
 void platform_init(int argc [[maybe_unused]], char* argv[]) {
+  memory_init(); // Before anything allocates through CF
   log_init();
 
   log_info("platform", "Initializing platform...");
@@ -46,9 +65,9 @@ void platform_init(int argc [[maybe_unused]], char* argv[]) {
       cf_make_app(GAME_NAME, 0, 0, 0, CANVAS_WIDTH * CANVAS_SCALE,
                   CANVAS_HEIGHT * CANVAS_SCALE, options, argv[0]);
 
-  cf_set_fixed_timestep(60);
-  cf_set_target_framerate(60);
-  cf_app_set_vsync(false);
+  // Fixed-step simulation; render follows the display
+  cf_set_fixed_timestep(SIM_TICK_RATE);
+  cf_app_set_vsync(true);
 
   if (cf_is_error(result)) {
     log_fatal("platform", "Failed to create app: %s", result.details);
@@ -58,30 +77,119 @@ void platform_init(int argc [[maybe_unused]], char* argv[]) {
   // Mount assets directory
 #ifdef ASSETS_PATH
   // Development: mount source assets directly
-  log_debug("platform", "Mounting assets from: %s", ASSETS_PATH);
-  cf_fs_mount(ASSETS_PATH, "/assets", true);
+  snprintf(assets_path, sizeof(assets_path), "%s", ASSETS_PATH);
 #else
   // Release: assets are next to executable
   const char* base = cf_fs_get_base_directory();
-  char assets_path[512];
   snprintf(assets_path, sizeof(assets_path), "%sassets", base);
+#endif
   log_debug("platform", "Mounting assets from: %s", assets_path);
   cf_fs_mount(assets_path, "/assets", true);
-#endif
 
   log_debug("platform", "Base directory: %s", cf_fs_get_base_directory());
   log_debug("platform", "Working directory: %s", cf_fs_get_working_directory());
+  platform_jobs_init();
+
   log_debug("platform", "Platform initialized!");
 }
 
-void platform_shutdown(void) { cf_destroy_app(); }
+void platform_shutdown(void) {
+#ifdef ENGINE_HOT_RELOADING
+  platform_watch_stop();
+#endif
+  platform_jobs_shutdown();
+  cf_destroy_app();
+  log_shutdown();
+}
 
 int platform_get_page_size(void) {
   return 4096; // TODO: Use SDL_GetSystemPageSize() after SDL 3.4.0;
 }
 
-GameLibrary platform_load_game_library(void) {
-  GameLibrary game_library = {0};
+// Memory-maps a file under the mounted assets directory. Bypasses the CF
+// filesystem, which can only read whole files into memory.
+const void* platform_map_file(const char* path, size_t* size) {
+  const char* prefix = "assets/";
+  if (path[0] == '/') {
+    path++;
+  }
+  if (strncmp(path, prefix, strlen(prefix)) != 0) {
+    return nullptr;
+  }
+
+  char full_path[MAX_PATH_LENGTH];
+  snprintf(full_path, sizeof(full_path), "%s/%s", assets_path,
+           path + strlen(prefix));
+
+#ifdef SDL_PLATFORM_WIN32
+  HANDLE file = CreateFileA(full_path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+
+  LARGE_INTEGER file_size;
+  HANDLE mapping = nullptr;
+  if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  }
+  CloseHandle(file);
+  if (!mapping) {
+    return nullptr;
+  }
+
+  const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!data) {
+    return nullptr;
+  }
+
+  *size = (size_t)file_size.QuadPart;
+#else
+  int fd = open(full_path, O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat st;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+
+  *size = (size_t)st.st_size;
+#endif
+
+  log_debug("platform", "Mapped %s (%zu bytes)", full_path, *size);
+  return data;
+}
+
+void platform_unmap_file(const void* data, size_t size [[maybe_unused]]) {
+#ifdef SDL_PLATFORM_WIN32
+  UnmapViewOfFile(data);
+#else
+  munmap((void*)data, size);
+#endif
+}
+
+void platform_begin_frame(void) {}
+void platform_end_frame(void) {
+  cf_app_draw_onto_screen(true);
+  memory_end_frame();
+}
+
+// =============================================================================
+// Game Library (hot reloading builds; release links the game statically)
+// =============================================================================
+
+#ifdef ENGINE_HOT_RELOADING
+
+GameLibrary platform_load_game_library(const GameLibrary* current) {
+  GameLibrary game_library = {.copy = current ? current->copy ^ 1 : 0};
 
   const char* base_path = SDL_GetBasePath();
   if (!base_path) {
@@ -91,34 +199,31 @@ GameLibrary platform_load_game_library(void) {
 
   const char* game_library_name =
       GAME_LIB_PREFIX GAME_LIB_BASENAME GAME_LIB_SUFFIX;
-#ifdef SDL_PLATFORM_WIN32
-  const char* game_library_copy_name =
-      GAME_LIB_PREFIX GAME_LIB_BASENAME "_copy" GAME_LIB_SUFFIX;
-  SDL_snprintf(game_library_copy_path, CF_ARRAY_SIZE(game_library_copy_path),
-               "%s%s", base_path, game_library_copy_name);
-#endif
+  char* copy_path = game_library_copy_paths[game_library.copy];
+  SDL_snprintf(copy_path, MAX_PATH_LENGTH, "%s%s_copy%d%s", base_path,
+               GAME_LIB_PREFIX GAME_LIB_BASENAME, game_library.copy,
+               GAME_LIB_SUFFIX);
 
   SDL_snprintf(game_library_path, CF_ARRAY_SIZE(game_library_path), "%s%s",
                base_path, game_library_name);
 
-  if (!SDL_GetPathInfo(game_library_path, &path_info)) {
+  if (!SDL_GetPathInfo(game_library_path, nullptr)) {
     log_error("platform", "Failed to get path info (%s): %s", game_library_path,
               SDL_GetError());
     return game_library;
   }
 
-#ifdef SDL_PLATFORM_WIN32
-  if (!SDL_CopyFile(game_library_path, game_library_copy_path)) {
+  // The original, not the copy: that is what the build rewrites
+  if (!game_library_watched) {
+    platform_watch_start(game_library_path);
+    game_library_watched = true;
+  }
+
+  if (!SDL_CopyFile(game_library_path, copy_path)) {
     log_error("platform", "Failed to copy library: %s", SDL_GetError());
     return game_library;
   }
-#endif
-
-#ifdef SDL_PLATFORM_WIN32
-  game_library.path = game_library_copy_path;
-#else
-  game_library.path = game_library_path;
-#endif
+  game_library.path = copy_path;
 
   game_library.library = cf_load_shared_library(game_library.path);
   if (!game_library.library) {
@@ -161,6 +266,20 @@ GameLibrary platform_load_game_library(void) {
     return game_library;
   }
 
+  game_library.state_layout = (GameStateLayoutFunction)cf_load_function(
+      game_library.library, "game_state_layout");
+  if (!game_library.state_layout) {
+    log_error("platform", "Failed to load function: %s", SDL_GetError());
+    return game_library;
+  }
+
+  game_library.prepare_reload = (GamePrepareReloadFunction)cf_load_function(
+      game_library.library, "game_prepare_reload");
+  if (!game_library.prepare_reload) {
+    log_error("platform", "Failed to load function: %s", SDL_GetError());
+    return game_library;
+  }
+
   game_library.hot_reload = (GameHotReloadFunction)cf_load_function(
       game_library.library, "game_hot_reload");
   if (!game_library.hot_reload) {
@@ -173,26 +292,30 @@ GameLibrary platform_load_game_library(void) {
   return game_library;
 }
 
-void platform_begin_frame(void) {}
-void platform_end_frame(void) { cf_app_draw_onto_screen(true); }
-
 void platform_unload_game_library(GameLibrary* game_library) {
+  // Workers must not be running game code when it is unmapped
+  platform_jobs_wait_idle();
+
+  // Queued records point at tag and file literals inside the library
+  log_flush();
+
   cf_unload_shared_library(game_library->library);
-  game_library->hot_reload = nullptr;
-  game_library->state      = nullptr;
-  game_library->shutdown   = nullptr;
-  game_library->render     = nullptr;
-  game_library->update     = nullptr;
-  game_library->init       = nullptr;
-  game_library->library    = nullptr;
-  game_library->ok         = false;
+  game_library->hot_reload     = nullptr;
+  game_library->prepare_reload = nullptr;
+  game_library->state_layout   = nullptr;
+  game_library->state          = nullptr;
+  game_library->shutdown       = nullptr;
+  game_library->render         = nullptr;
+  game_library->update         = nullptr;
+  game_library->init           = nullptr;
+  game_library->library        = nullptr;
+  game_library->ok             = false;
 }
 
-bool platform_game_library_has_changed(GameLibrary* game_library) {
-  SDL_PathInfo new_path_info;
-  if (!SDL_GetPathInfo(game_library->path, &new_path_info)) {
-    log_error("platform", "Failed to get path info: %s", SDL_GetError());
-    return false;
-  }
-  return new_path_info.modify_time != path_info.modify_time;
+// Set by the watcher thread once a rebuilt library has been fully written
+bool platform_game_library_has_changed(
+    [[maybe_unused]] GameLibrary* game_library) {
+  return platform_watch_poll();
 }
+
+#endif // ENGINE_HOT_RELOADING
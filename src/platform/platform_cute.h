@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef struct Input Input;
 typedef struct Platform Platform;
@@ -10,17 +12,22 @@ typedef bool (*GameUpdateFunction)(void);
 typedef void (*GameRenderFunction)(void);
 typedef void (*GameShutdownFunction)(void);
 typedef void* (*GameStateFunction)(void);
+typedef uint64_t (*GameStateLayoutFunction)(void);
+typedef void (*GamePrepareReloadFunction)(void);
 typedef void (*GameHotReloadFunction)(void* game_state);
 
 typedef struct GameLibrary {
   void* library;
   const char* path;
+  int copy; // Which of the two library copies `path` is
 
   GameInitFunction init;
   GameUpdateFunction update;
   GameRenderFunction render;
   GameShutdownFunction shutdown;
   GameStateFunction state;
+  GameStateLayoutFunction state_layout;
+  GamePrepareReloadFunction prepare_reload;
   GameHotReloadFunction hot_reload;
 
   bool ok;
@@ -31,9 +38,16 @@ void platform_shutdown(void);
 
 int platform_get_page_size(void);
 
+const void* platform_map_file(const char* path, size_t* size);
+void platform_unmap_file(const void* data, size_t size);
+
 void platform_begin_frame(void);
 void platform_end_frame(void);
 
-GameLibrary platform_load_game_library(void);
+#ifdef ENGINE_HOT_RELOADING
+// Loads a copy of the built library. `current` (may be nullptr) stays loaded:
+// the new one goes to the other copy, so both can be open at once.
+GameLibrary platform_load_game_library(const GameLibrary* current);
 void platform_unload_game_library(GameLibrary* game_library);
 bool platform_game_library_has_changed(GameLibrary* game_library);
+#endif
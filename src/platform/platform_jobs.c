@@ -0,0 +1,250 @@
+#include "platform_jobs.h"
+
+#include <SDL3/SDL_atomic.h>
+#include <cute_c_runtime.h>
+#include <cute_multithreading.h>
+#include <stddef.h>
+
+#include "../engine/log.h"
+
+// Work-stealing pool: every thread owns a deque. Owners push and pop at the
+// bottom (LIFO, cache-warm), idle threads steal from the top (FIFO, oldest and
+// usually largest work). Deque 0 belongs to the main thread.
+
+#define JOBS_MAX_THREADS 64
+#define JOBS_DEQUE_CAPACITY 1024 // Power of two
+#define JOBS_BATCHES_PER_THREAD 4
+
+typedef struct Job {
+  JobFunction fn;
+  JobRangeFunction range_fn;
+  void* udata;
+  size_t begin;
+  size_t end;
+  JobCounter* counter;
+} Job;
+
+typedef struct JobDeque {
+  CF_Mutex lock;
+  size_t top;    // Steal end
+  size_t bottom; // Owner end
+  Job jobs[JOBS_DEQUE_CAPACITY];
+} JobDeque;
+
+static struct {
+  JobDeque deques[JOBS_MAX_THREADS];
+  CF_Thread* threads[JOBS_MAX_THREADS];
+  int thread_count; // Including the main thread
+
+  CF_Semaphore wake;        // Posted once per queued job
+  CF_AtomicInt outstanding; // Queued or running jobs
+  CF_AtomicInt running;
+} jobs;
+
+static _Thread_local int job_thread_index = 0;
+
+// =============================================================================
+// Deques
+// =============================================================================
+
+static bool deque_push(JobDeque* deque, const Job* job) {
+  cf_mutex_lock(&deque->lock);
+  bool ok = deque->bottom - deque->top < JOBS_DEQUE_CAPACITY;
+  if (ok) {
+    deque->jobs[deque->bottom++ & (JOBS_DEQUE_CAPACITY - 1)] = *job;
+  }
+  cf_mutex_unlock(&deque->lock);
+  return ok;
+}
+
+static bool deque_pop(JobDeque* deque, Job* job) {
+  cf_mutex_lock(&deque->lock);
+  bool ok = deque->bottom > deque->top;
+  if (ok) {
+    *job = deque->jobs[--deque->bottom & (JOBS_DEQUE_CAPACITY - 1)];
+  }
+  cf_mutex_unlock(&deque->lock);
+  return ok;
+}
+
+static bool deque_steal(JobDeque* deque, Job* job) {
+  cf_mutex_lock(&deque->lock);
+  bool ok = deque->bottom > deque->top;
+  if (ok) {
+    *job = deque->jobs[deque->top++ & (JOBS_DEQUE_CAPACITY - 1)];
+  }
+  cf_mutex_unlock(&deque->lock);
+  return ok;
+}
+
+// =============================================================================
+// Execution
+// =============================================================================
+
+static void job_execute(const Job* job) {
+  if (job->range_fn) {
+    job->range_fn(job->udata, job->begin, job->end);
+  } else {
+    job->fn(job->udata);
+  }
+
+  if (job->counter) {
+    cf_atomic_add(&job->counter->pending, -1);
+  }
+  cf_atomic_add(&jobs.outstanding, -1);
+}
+
+// Pops local work first, then steals round-robin from the other threads.
+static bool job_find(Job* job) {
+  int self = job_thread_index;
+  if (deque_pop(&jobs.deques[self], job)) {
+    return true;
+  }
+
+  for (int i = 1; i < jobs.thread_count; i++) {
+    int victim = (self + i) % jobs.thread_count;
+    if (deque_steal(&jobs.deques[victim], job)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static bool job_run_one(void) {
+  Job job;
+  if (!job_find(&job)) {
+    return false;
+  }
+  job_execute(&job);
+  return true;
+}
+
+static int job_worker(void* udata) {
+  job_thread_index = (int)(size_t)udata;
+
+  while (cf_atomic_get(&jobs.running)) {
+    cf_sem_wait(&jobs.wake);
+    while (job_run_one()) {
+    }
+  }
+
+  return 0;
+}
+
+static void job_push(const Job* job) {
+  if (job->counter) {
+    cf_atomic_add(&job->counter->pending, 1);
+  }
+  cf_atomic_add(&jobs.outstanding, 1);
+
+  if (!deque_push(&jobs.deques[job_thread_index], job)) {
+    // Deque full: run inline rather than drop work
+    job_execute(job);
+    return;
+  }
+
+  cf_sem_post(&jobs.wake);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void platform_jobs_init(void) {
+  int cores         = cf_core_count();
+  jobs.thread_count = cores < 1                  ? 1
+                      : cores > JOBS_MAX_THREADS ? JOBS_MAX_THREADS
+                                                 : cores;
+
+  for (int i = 0; i < jobs.thread_count; i++) {
+    jobs.deques[i].lock = cf_make_mutex();
+  }
+
+  jobs.wake = cf_make_sem(0);
+  cf_atomic_set(&jobs.outstanding, 0);
+  cf_atomic_set(&jobs.running, 1);
+
+  // Thread 0 is the caller (main thread)
+  job_thread_index = 0;
+  for (int i = 1; i < jobs.thread_count; i++) {
+    jobs.threads[i] =
+        cf_thread_create(job_worker, "job_worker", (void*)(size_t)i);
+  }
+
+  log_debug("platform", "Job system started with %d workers",
+            jobs.thread_count - 1);
+}
+
+void platform_jobs_shutdown(void) {
+  platform_jobs_wait_idle();
+
+  cf_atomic_set(&jobs.running, 0);
+  for (int i = 1; i < jobs.thread_count; i++) {
+    cf_sem_post(&jobs.wake);
+  }
+  for (int i = 1; i < jobs.thread_count; i++) {
+    cf_thread_wait(jobs.threads[i]);
+    jobs.threads[i] = nullptr;
+  }
+
+  for (int i = 0; i < jobs.thread_count; i++) {
+    cf_destroy_mutex(&jobs.deques[i].lock);
+    jobs.deques[i].top    = 0;
+    jobs.deques[i].bottom = 0;
+  }
+  cf_destroy_sem(&jobs.wake);
+  jobs.thread_count = 0;
+}
+
+int platform_jobs_worker_count(void) { return jobs.thread_count - 1; }
+
+void platform_jobs_submit(JobFunction fn, void* udata, JobCounter* counter) {
+  CF_ASSERT(fn);
+  job_push(&(Job){.fn = fn, .udata = udata, .counter = counter});
+}
+
+void platform_jobs_parallel_for(size_t count, size_t min_batch,
+                                JobRangeFunction fn, void* udata,
+                                JobCounter* counter) {
+  CF_ASSERT(fn);
+  if (count == 0) {
+    return;
+  }
+
+  size_t batches = 1;
+  if (min_batch > 0 && count > min_batch) {
+    size_t max_batches =
+        (size_t)jobs.thread_count * JOBS_BATCHES_PER_THREAD;
+    batches = (count + min_batch - 1) / min_batch;
+    batches = batches < max_batches ? batches : max_batches;
+  }
+
+  size_t batch_size = (count + batches - 1) / batches;
+  for (size_t begin = 0; begin < count; begin += batch_size) {
+    size_t end = count - begin < batch_size ? count : begin + batch_size;
+    job_push(&(Job){.range_fn = fn,
+                    .udata    = udata,
+                    .begin    = begin,
+                    .end      = end,
+                    .counter  = counter});
+  }
+}
+
+void platform_jobs_wait(JobCounter* counter) {
+  // Help out instead of blocking; spin only when all remaining work is
+  // already running on other threads
+  while (cf_atomic_get(&counter->pending) > 0) {
+    if (!job_run_one()) {
+      SDL_CPUPauseInstruction();
+    }
+  }
+}
+
+void platform_jobs_wait_idle(void) {
+  while (cf_atomic_get(&jobs.outstanding) > 0) {
+    if (!job_run_one()) {
+      SDL_CPUPauseInstruction();
+    }
+  }
+}
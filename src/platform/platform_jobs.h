@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "../engine/platform.h"
+
+void platform_jobs_init(void);
+void platform_jobs_shutdown(void);
+
+int platform_jobs_worker_count(void);
+void platform_jobs_submit(JobFunction fn, void* udata, JobCounter* counter);
+void platform_jobs_parallel_for(size_t count, size_t min_batch,
+                                JobRangeFunction fn, void* udata,
+                                JobCounter* counter);
+void platform_jobs_wait(JobCounter* counter);
+
+// Waits for every queued and running job. Call before unloading the game
+// library so no worker is left executing its code.
+void platform_jobs_wait_idle(void);
@@ -0,0 +1,333 @@
+#include "platform_watch.h"
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+#include <cute_multithreading.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(SDL_PLATFORM_LINUX)
+#include <poll.h>
+#include <stdalign.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(SDL_PLATFORM_MACOS)
+#include <CoreServices/CoreServices.h>
+#include <SDL3/SDL_mutex.h>
+#elif defined(SDL_PLATFORM_WIN32)
+#include <stdalign.h>
+#include <windows.h>
+#endif
+
+#include "../engine/log.h"
+
+// The directory is watched rather than the file, since linkers often replace
+// the file instead of rewriting it.
+
+#define WATCH_PATH_LENGTH 1024
+#define WATCH_WAIT_MS 100   // Longest block, bounds how long stopping takes
+#define WATCH_SETTLE_MS 100 // Quiet time before a change is reported
+
+static struct {
+  char path[WATCH_PATH_LENGTH]; // Watched file
+  char dir[WATCH_PATH_LENGTH];  // Its directory
+  const char* name;             // File name within `path`
+
+  CF_Thread* thread;
+  CF_AtomicInt running;
+  CF_AtomicInt changed; // Set by the watcher, cleared by platform_watch_poll
+
+  bool polling;         // No native backend: compare modify times
+  SDL_Time modify_time; // Polling: last seen
+
+#if defined(SDL_PLATFORM_LINUX)
+  int fd;
+#elif defined(SDL_PLATFORM_MACOS)
+  FSEventStreamRef stream;
+  dispatch_queue_t queue;
+  SDL_Semaphore* event; // Posted from the FSEvents queue
+#elif defined(SDL_PLATFORM_WIN32)
+  HANDLE handle;
+  OVERLAPPED overlapped;
+  WCHAR wide_name[MAX_PATH];
+  alignas(DWORD) uint8_t buffer[4096];
+#endif
+} watch;
+
+// =============================================================================
+// Backends
+// =============================================================================
+// watch_open starts listening on watch.dir; watch_read blocks for up to
+// timeout_ms and returns true if watch.name was written or replaced.
+
+#if defined(SDL_PLATFORM_LINUX)
+
+static bool watch_open(void) {
+  watch.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (watch.fd < 0) {
+    return false;
+  }
+
+  // Closing after a write or renaming into place: the file is complete
+  if (inotify_add_watch(watch.fd, watch.dir, IN_CLOSE_WRITE | IN_MOVED_TO) <
+      0) {
+    close(watch.fd);
+    return false;
+  }
+  return true;
+}
+
+static void watch_close(void) { close(watch.fd); }
+
+static bool watch_read(int timeout_ms) {
+  struct pollfd pfd = {.fd = watch.fd, .events = POLLIN};
+  if (poll(&pfd, 1, timeout_ms) <= 0) {
+    return false;
+  }
+
+  alignas(struct inotify_event) char buffer[4096];
+  ssize_t length = read(watch.fd, buffer, sizeof(buffer));
+
+  bool hit = false;
+  for (ssize_t offset = 0; offset < length;) {
+    const struct inotify_event* event =
+        (const struct inotify_event*)(buffer + offset);
+    if ((event->mask & IN_Q_OVERFLOW) ||
+        (event->len > 0 && strcmp(event->name, watch.name) == 0)) {
+      hit = true;
+    }
+    offset += (ssize_t)(sizeof(*event) + event->len);
+  }
+  return hit;
+}
+
+#elif defined(SDL_PLATFORM_MACOS)
+
+static void
+watch_callback([[maybe_unused]] ConstFSEventStreamRef stream,
+               [[maybe_unused]] void* info, size_t count, void* paths,
+               [[maybe_unused]] const FSEventStreamEventFlags* flags,
+               [[maybe_unused]] const FSEventStreamEventId* ids) {
+  const char** event_paths = paths;
+  for (size_t i = 0; i < count; i++) {
+    const char* name = strrchr(event_paths[i], '/');
+    if (name && strcmp(name + 1, watch.name) == 0) {
+      SDL_SignalSemaphore(watch.event);
+      return;
+    }
+  }
+}
+
+static void watch_close(void) {
+  FSEventStreamStop(watch.stream);
+  FSEventStreamInvalidate(watch.stream);
+  FSEventStreamRelease(watch.stream);
+  dispatch_release(watch.queue);
+  SDL_DestroySemaphore(watch.event);
+}
+
+static bool watch_open(void) {
+  CFStringRef dir =
+      CFStringCreateWithCString(nullptr, watch.dir, kCFStringEncodingUTF8);
+  CFArrayRef dirs =
+      CFArrayCreate(nullptr, (const void**)&dir, 1, &kCFTypeArrayCallBacks);
+
+  // File-level events, delivered as they happen; settling is done here
+  watch.stream = FSEventStreamCreate(
+      nullptr, watch_callback, nullptr, dirs, kFSEventStreamEventIdSinceNow,
+      0.0,
+      kFSEventStreamCreateFlagFileEvents | kFSEventStreamCreateFlagNoDefer);
+  CFRelease(dirs);
+  CFRelease(dir);
+  if (!watch.stream) {
+    return false;
+  }
+
+  watch.event = SDL_CreateSemaphore(0);
+  watch.queue = dispatch_queue_create("platform_watch", DISPATCH_QUEUE_SERIAL);
+  FSEventStreamSetDispatchQueue(watch.stream, watch.queue);
+
+  if (!FSEventStreamStart(watch.stream)) {
+    watch_close();
+    return false;
+  }
+  return true;
+}
+
+static bool watch_read(int timeout_ms) {
+  return SDL_WaitSemaphoreTimeout(watch.event, timeout_ms);
+}
+
+#elif defined(SDL_PLATFORM_WIN32)
+
+static bool watch_request(void) {
+  return ReadDirectoryChangesW(
+      watch.handle, watch.buffer, sizeof(watch.buffer), FALSE,
+      FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+          FILE_NOTIFY_CHANGE_SIZE,
+      nullptr, &watch.overlapped, nullptr);
+}
+
+static bool watch_open(void) {
+  watch.handle = CreateFileA(
+      watch.dir, FILE_LIST_DIRECTORY,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+      nullptr);
+  if (watch.handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  MultiByteToWideChar(CP_UTF8, 0, watch.name, -1, watch.wide_name, MAX_PATH);
+  watch.overlapped =
+      (OVERLAPPED){.hEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr)};
+
+  if (!watch_request()) {
+    CloseHandle(watch.overlapped.hEvent);
+    CloseHandle(watch.handle);
+    return false;
+  }
+  return true;
+}
+
+static void watch_close(void) {
+  DWORD length = 0;
+  CancelIoEx(watch.handle, &watch.overlapped);
+  GetOverlappedResult(watch.handle, &watch.overlapped, &length, TRUE);
+  CloseHandle(watch.overlapped.hEvent);
+  CloseHandle(watch.handle);
+}
+
+static bool watch_read(int timeout_ms) {
+  if (WaitForSingleObject(watch.overlapped.hEvent, (DWORD)timeout_ms) !=
+      WAIT_OBJECT_0) {
+    return false;
+  }
+
+  DWORD length = 0;
+  bool hit     = false;
+  if (GetOverlappedResult(watch.handle, &watch.overlapped, &length, FALSE)) {
+    hit = length == 0; // Buffer overflowed, changes were dropped
+
+    for (DWORD offset = 0; length > 0;) {
+      const FILE_NOTIFY_INFORMATION* info =
+          (const FILE_NOTIFY_INFORMATION*)(watch.buffer + offset);
+      size_t chars = info->FileNameLength / sizeof(WCHAR);
+      if (wcsncmp(info->FileName, watch.wide_name, chars) == 0 &&
+          watch.wide_name[chars] == L'\0') {
+        hit = true;
+      }
+
+      if (info->NextEntryOffset == 0) {
+        break;
+      }
+      offset += info->NextEntryOffset;
+    }
+  }
+
+  watch_request();
+  return hit;
+}
+
+#else
+
+static bool watch_open(void) { return false; }
+static void watch_close(void) {}
+static bool watch_read([[maybe_unused]] int timeout_ms) { return false; }
+
+#endif
+
+// Fallback: one stat per wait instead of one per update
+static bool watch_stat(int timeout_ms) {
+  SDL_Delay((Uint32)timeout_ms);
+
+  SDL_PathInfo info;
+  if (!SDL_GetPathInfo(watch.path, &info) ||
+      info.modify_time == watch.modify_time) {
+    return false;
+  }
+
+  watch.modify_time = info.modify_time;
+  return true;
+}
+
+// =============================================================================
+// Watcher Thread
+// =============================================================================
+
+static bool watch_wait(int timeout_ms) {
+  return watch.polling ? watch_stat(timeout_ms) : watch_read(timeout_ms);
+}
+
+static int watch_thread([[maybe_unused]] void* udata) {
+  while (cf_atomic_get(&watch.running)) {
+    if (!watch_wait(WATCH_WAIT_MS)) {
+      continue;
+    }
+
+    // Linkers write in several passes; report once they have stopped
+    while (cf_atomic_get(&watch.running) && watch_wait(WATCH_SETTLE_MS)) {
+    }
+
+    cf_atomic_set(&watch.changed, 1);
+  }
+  return 0;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void platform_watch_start(const char* path) {
+  snprintf(watch.path, sizeof(watch.path), "%s", path);
+  snprintf(watch.dir, sizeof(watch.dir), "%s", path);
+
+  // Split at the last separator (SDL base paths use '\' on Windows)
+  char* separator = nullptr;
+  for (char* c = watch.dir; *c; c++) {
+    if (*c == '/' || *c == '\\') {
+      separator = c;
+    }
+  }
+  if (separator) {
+    *separator = '\0';
+    watch.name = watch.path + (separator - watch.dir) + 1;
+  } else {
+    snprintf(watch.dir, sizeof(watch.dir), ".");
+    watch.name = watch.path;
+  }
+
+  watch.polling = !watch_open();
+  if (watch.polling) {
+    log_warn("platform", "Cannot watch %s, polling it instead", watch.dir);
+
+    SDL_PathInfo info;
+    watch.modify_time =
+        SDL_GetPathInfo(watch.path, &info) ? info.modify_time : 0;
+  }
+
+  cf_atomic_set(&watch.changed, 0);
+  cf_atomic_set(&watch.running, 1);
+  watch.thread = cf_thread_create(watch_thread, "platform_watch", nullptr);
+
+  log_debug("platform", "Watching %s", watch.path);
+}
+
+void platform_watch_stop(void) {
+  if (!watch.thread) {
+    return;
+  }
+
+  cf_atomic_set(&watch.running, 0);
+  cf_thread_wait(watch.thread);
+  watch.thread = nullptr;
+
+  if (!watch.polling) {
+    watch_close();
+  }
+}
+
+bool platform_watch_poll(void) { return cf_atomic_set(&watch.changed, 0) != 0; }
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdbool.h>
+
+// Watches one file from a background thread (inotify, FSEvents or
+// ReadDirectoryChangesW; a slow stat poll elsewhere). A change is reported
+// once the file has been quiet for a moment, so a linker still writing it is
+// never picked up halfway.
+
+void platform_watch_start(const char* path);
+void platform_watch_stop(void);
+
+// True once for every settled change since the previous call.
+bool platform_watch_poll(void);